@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+
+#include "core/globals.h"
+
+namespace bacon
+{
+	namespace bench
+	{
+		typedef std::chrono::steady_clock clock;
+
+		/**
+		 * Shared settings and the result sink.
+		 * Every result is printed as one JSON object per line.
+		 */
+		typedef struct Context
+		{
+			int samples = 10;
+			bool quick = false;
+			// Benchmarks run with a const Context, see fail()
+			mutable int failures = 0;
+
+			void report(const std::string& name,
+				const nlohmann::json& params,
+				std::vector<double> sample_ms,
+				size_t items = 0) const
+			{
+				nlohmann::json result;
+				result["bench"] = name;
+				result["version"] = globals::engine_version;
+				result["params"] = params;
+				result["samples"] = sample_ms.size();
+
+				if (!sample_ms.empty())
+				{
+					std::sort(sample_ms.begin(), sample_ms.end());
+
+					double total = 0.0;
+					for (double ms : sample_ms)
+					{
+						total += ms;
+					}
+					double mean = total / sample_ms.size();
+
+					result["mean_ms"] = mean;
+					result["median_ms"] = sample_ms[sample_ms.size() / 2];
+					result["min_ms"] = sample_ms.front();
+					result["max_ms"] = sample_ms.back();
+					if (items > 0)
+					{
+						result["items"] = items;
+						result["ns_per_item"] = mean * 1e6 / items;
+					}
+				}
+
+				printf("%s\n", result.dump().c_str());
+				fflush(stdout);
+			}
+
+			void skip(const std::string& name, const std::string& reason) const
+			{
+				nlohmann::json result;
+				result["bench"] = name;
+				result["version"] = globals::engine_version;
+				result["skipped"] = reason;
+
+				printf("%s\n", result.dump().c_str());
+				fflush(stdout);
+			}
+
+			/**
+			 * Records a benchmark that produced wrong results, as
+			 * opposed to slow ones. bacon_bench exits non-zero if
+			 * any benchmark failed.
+			 */
+			void fail(const std::string& name, const std::string& reason) const
+			{
+				nlohmann::json result;
+				result["bench"] = name;
+				result["version"] = globals::engine_version;
+				result["failed"] = reason;
+
+				printf("%s\n", result.dump().c_str());
+				fflush(stdout);
+
+				failures++;
+			}
+		} Context;
+
+		typedef struct
+		{
+			const char* name;
+			std::function<void(const Context&)> run;
+		} Benchmark;
+
+		template <typename F>
+		double time_ms(F&& function)
+		{
+			clock::time_point start = clock::now();
+			function();
+			return std::chrono::duration<double, std::milli>(clock::now() - start).count();
+		}
+
+		void register_scene_benchmarks(std::vector<Benchmark>& benchmarks);
+		void register_physics_benchmarks(std::vector<Benchmark>& benchmarks);
+		void register_serialization_benchmarks(std::vector<Benchmark>& benchmarks);
+		void register_text_benchmarks(std::vector<Benchmark>& benchmarks);
+		void register_memory_benchmarks(std::vector<Benchmark>& benchmarks);
+		void register_asset_benchmarks(std::vector<Benchmark>& benchmarks);
+	} // namespace bench
+} // namespace bacon
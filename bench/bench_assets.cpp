@@ -0,0 +1,158 @@
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "raylib.h"
+
+#include "bench.h"
+#include "file/asset_cache.h"
+#include "file/asset_manager_2d.h"
+
+namespace bacon
+{
+	namespace bench
+	{
+		static std::vector<std::string> write_test_images(size_t count, int size)
+		{
+			std::filesystem::path directory = std::filesystem::path(globals::project_directory) / "bench_images";
+			std::filesystem::create_directories(directory);
+
+			std::vector<std::string> paths;
+			for (size_t i = 0; i < count; i++)
+			{
+				std::string path = (directory / ("image_" + std::to_string(i) + ".png")).generic_string();
+				if (!std::filesystem::exists(path))
+				{
+					Image image = GenImagePerlinNoise(size, size, (int)i * size, 0, 4.f);
+					ExportImage(image, path.c_str());
+					UnloadImage(image);
+				}
+				paths.push_back(path);
+			}
+
+			return paths;
+		}
+
+		/**
+		 * Main thread time to request a set of new textures:
+		 * blocking loads versus async requests plus the per-frame
+		 * upload work until every texture is ready.
+		 */
+		static void texture_load(const Context& context)
+		{
+			if (!IsWindowReady())
+			{
+				context.skip("texture_load", "no window for texture uploads");
+				return;
+			}
+
+			const size_t count = context.quick ? 16 : 64;
+			const int size = 512;
+			std::vector<std::string> paths = write_test_images(count, size);
+
+			std::vector<double> blocking_ms;
+			std::vector<double> request_ms;
+			std::vector<double> longest_update_ms;
+			std::vector<double> total_ms;
+			for (int sample = 0; sample < context.samples; sample++)
+			{
+				{
+					AssetManager2D assets;
+					blocking_ms.push_back(time_ms([&]()
+						{
+							for (const std::string& path : paths)
+							{
+								assets.load_texture(path);
+							}
+						}));
+				}
+
+				AssetManager2D assets;
+				double longest = 0.0;
+				total_ms.push_back(time_ms([&]()
+					{
+						request_ms.push_back(time_ms([&]()
+							{
+								for (const std::string& path : paths)
+								{
+									assets.load_texture_async(path);
+								}
+							}));
+
+						while (assets.get_pending_count() > 0)
+						{
+							longest = std::max(longest, time_ms([&]()
+								{
+									assets.update();
+								}));
+						}
+					}));
+				longest_update_ms.push_back(longest);
+			}
+
+			nlohmann::json params = {{"count", count}, {"size", size}};
+			context.report("texture_load_blocking", params, blocking_ms, count);
+			context.report("texture_load_async_request", params, request_ms, count);
+			context.report("texture_load_async_longest_frame", params, longest_update_ms);
+			context.report("texture_load_async_total", params, total_ms, count);
+		}
+
+		/**
+		 * CPU side of a cold texture load: decoding the PNG versus
+		 * mapping the raw pixels from the import cache. Needs no
+		 * window, so it also runs headless.
+		 */
+		static void texture_import_cache(const Context& context)
+		{
+			const size_t count = context.quick ? 16 : 64;
+			const int size = 512;
+			std::vector<std::string> paths = write_test_images(count, size);
+
+			AssetCache cache(globals::project_directory);
+			cache.import_directory((std::filesystem::path(globals::project_directory) / "bench_images").generic_string(), false);
+
+			std::vector<double> decode_ms;
+			std::vector<double> cached_ms;
+			for (int sample = 0; sample < context.samples; sample++)
+			{
+				decode_ms.push_back(time_ms([&]()
+					{
+						for (const std::string& path : paths)
+						{
+							Image image = LoadImage(path.c_str());
+							UnloadImage(image);
+						}
+					}));
+
+				cached_ms.push_back(time_ms([&]()
+					{
+						for (const std::string& path : paths)
+						{
+							// Touch every page, as an upload would
+							CachedImage cached;
+							if (cache.read_image(path, cached))
+							{
+								const uint8_t* pixels = (const uint8_t*)cached.image.data;
+								size_t bytes = (size_t)GetPixelDataSize(cached.image.width, cached.image.height, cached.image.format);
+								volatile uint8_t sum = 0;
+								for (size_t i = 0; i < bytes; i += 4096)
+								{
+									sum = sum + pixels[i];
+								}
+							}
+						}
+					}));
+			}
+
+			nlohmann::json params = {{"count", count}, {"size", size}};
+			context.report("texture_decode_png", params, decode_ms, count);
+			context.report("texture_read_import_cache", params, cached_ms, count);
+		}
+
+		void register_asset_benchmarks(std::vector<Benchmark>& benchmarks)
+		{
+			benchmarks.push_back({"texture_load", texture_load});
+			benchmarks.push_back({"texture_import_cache", texture_import_cache});
+		}
+	} // namespace bench
+} // namespace bacon
@@ -0,0 +1,117 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "raylib.h"
+
+#include "bench.h"
+#include "core/game_state.h"
+#include "core/globals.h"
+#include "core/job_system.h"
+
+/*
+ * Engine benchmarks. Prints one JSON object per result line.
+ * Exits with 1 if a benchmark found wrong results (see Context::fail).
+ *
+ * Usage: bacon_bench [--filter TEXT] [--samples N] [--quick] [--list]
+ */
+
+int main(int argc, char** argv)
+{
+	using namespace bacon;
+
+	bench::Context context;
+	std::string filter;
+	bool list_only = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+		{
+			filter = argv[++i];
+		}
+		else if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc)
+		{
+			context.samples = std::max(1, atoi(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--quick") == 0)
+		{
+			context.quick = true;
+		}
+		else if (strcmp(argv[i], "--list") == 0)
+		{
+			list_only = true;
+		}
+		else
+		{
+			fprintf(stderr, "Usage: bacon_bench [--filter TEXT] [--samples N] [--quick] [--list]\n");
+			return 1;
+		}
+	}
+
+	std::vector<bench::Benchmark> benchmarks;
+	bench::register_scene_benchmarks(benchmarks);
+	bench::register_physics_benchmarks(benchmarks);
+	bench::register_serialization_benchmarks(benchmarks);
+	bench::register_text_benchmarks(benchmarks);
+	bench::register_memory_benchmarks(benchmarks);
+	bench::register_asset_benchmarks(benchmarks);
+
+	if (list_only)
+	{
+		for (const bench::Benchmark& benchmark : benchmarks)
+		{
+			printf("%s\n", benchmark.name);
+		}
+		return 0;
+	}
+
+	SetTraceLogLevel(LOG_ERROR);
+	globals::engine_version = "v0.1";
+
+	// A hidden window gives text benchmarks real font metrics.
+	// Without a display everything else still runs headless.
+	SetConfigFlags(FLAG_WINDOW_HIDDEN);
+	InitWindow(64, 64, "bacon_bench");
+	bool has_window = IsWindowReady();
+
+	globals::job_system = new JobSystem(0);
+	GameState::game_type = GameState::GameType::GAME_2D;
+	GameState::state_2d = new GameState2D(!has_window);
+
+	std::filesystem::path work_dir = std::filesystem::temp_directory_path() / "bacon_bench";
+	std::filesystem::create_directories(work_dir);
+	globals::project_directory = work_dir.generic_string();
+	globals::project_file = (work_dir / "bench_project.json").generic_string();
+
+	for (const bench::Benchmark& benchmark : benchmarks)
+	{
+		if (!filter.empty() && std::string(benchmark.name).find(filter) == std::string::npos)
+		{
+			continue;
+		}
+
+		benchmark.run(context);
+		GameState::state_2d->scene->reset();
+	}
+
+	GameState::cleanup();
+	delete globals::job_system;
+	globals::job_system = nullptr;
+
+	if (has_window)
+	{
+		CloseWindow();
+	}
+
+	if (context.failures > 0)
+	{
+		fprintf(stderr, "bacon_bench: %d benchmark(s) failed\n", context.failures);
+		return 1;
+	}
+
+	return 0;
+}
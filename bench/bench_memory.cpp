@@ -0,0 +1,452 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "bench.h"
+#include "lib/concurrent_pool_allocator.h"
+#include "lib/frame_arena.h"
+#include "lib/pool_allocator.h"
+
+namespace bacon
+{
+	namespace bench
+	{
+		typedef struct
+		{
+			char data[96];
+		} Payload;
+
+		/**
+		 * Allocate a batch, free a random half, refill it and free
+		 * everything, which is the pattern scene edits produce.
+		 */
+		static void pool_churn(const Context& context)
+		{
+			const size_t count = context.quick ? 20000 : 200000;
+			std::mt19937 random(1234);
+
+			// Random free order, fixed up front so it isn't timed
+			std::vector<size_t> order(count);
+			for (size_t i = 0; i < count; i++)
+			{
+				order[i] = i;
+			}
+			std::shuffle(order.begin(), order.end(), random);
+
+			std::vector<double> churn_ms;
+			for (int sample = 0; sample < context.samples; sample++)
+			{
+				PoolAllocator<Payload> pool(512);
+				std::vector<Payload*> live(count);
+
+				churn_ms.push_back(time_ms([&]()
+					{
+						for (size_t i = 0; i < count; i++)
+						{
+							live[i] = pool.allocate();
+						}
+
+						for (size_t i = count / 2; i < count; i++)
+						{
+							pool.deallocate(live[order[i]]);
+						}
+
+						for (size_t i = count / 2; i < count; i++)
+						{
+							live[order[i]] = pool.allocate();
+						}
+
+						for (Payload* payload : live)
+						{
+							pool.deallocate(payload);
+						}
+					}));
+			}
+
+			std::vector<double> heap_ms;
+			for (int sample = 0; sample < context.samples; sample++)
+			{
+				std::vector<Payload*> live(count);
+
+				heap_ms.push_back(time_ms([&]()
+					{
+						for (size_t i = 0; i < count; i++)
+						{
+							live[i] = new Payload;
+						}
+
+						for (size_t i = count / 2; i < count; i++)
+						{
+							delete live[order[i]];
+						}
+
+						for (size_t i = count / 2; i < count; i++)
+						{
+							live[order[i]] = new Payload;
+						}
+
+						for (Payload* payload : live)
+						{
+							delete payload;
+						}
+					}));
+			}
+
+			context.report("pool_churn", {{"count", count}}, churn_ms, count * 3);
+			context.report("heap_churn", {{"count", count}}, heap_ms, count * 3);
+		}
+
+		/**
+		 * Visiting every live object after churn: walking the pool's
+		 * occupancy bitmaps versus chasing a vector of pointers to
+		 * individually allocated objects.
+		 */
+		static void pool_iterate(const Context& context)
+		{
+			const size_t count = context.quick ? 20000 : 200000;
+			std::mt19937 random(1234);
+
+			std::vector<size_t> order(count);
+			for (size_t i = 0; i < count; i++)
+			{
+				order[i] = i;
+			}
+			std::shuffle(order.begin(), order.end(), random);
+
+			// Same live set in both: a random half freed and refilled
+			PoolAllocator<Payload> pool(512);
+			std::vector<Payload*> pooled(count);
+			std::vector<Payload*> heap(count);
+			for (size_t i = 0; i < count; i++)
+			{
+				pooled[i] = pool.create();
+				heap[i] = new Payload();
+			}
+			for (size_t i = count / 2; i < count; i++)
+			{
+				pool.destroy(pooled[order[i]]);
+				delete heap[order[i]];
+			}
+			for (size_t i = count / 2; i < count; i++)
+			{
+				pooled[order[i]] = pool.create();
+				heap[order[i]] = new Payload();
+			}
+
+			volatile size_t sink = 0;
+			std::vector<double> pool_ms;
+			std::vector<double> pointer_ms;
+			for (int sample = 0; sample < context.samples; sample++)
+			{
+				pool_ms.push_back(time_ms([&]()
+					{
+						size_t sum = 0;
+						for (Payload* payload : pool)
+						{
+							sum += (uint8_t)payload->data[0];
+						}
+						sink = sum;
+					}));
+
+				pointer_ms.push_back(time_ms([&]()
+					{
+						size_t sum = 0;
+						for (Payload* payload : heap)
+						{
+							sum += (uint8_t)payload->data[0];
+						}
+						sink = sum;
+					}));
+			}
+			(void)sink;
+
+			for (Payload* payload : heap)
+			{
+				delete payload;
+			}
+
+			context.report("pool_iterate_live", {{"count", count}}, pool_ms, count);
+			context.report("pointer_vector_iterate", {{"count", count}}, pointer_ms, count);
+		}
+
+		typedef struct
+		{
+			uint64_t stamp;
+			char data[88];
+		} StressPayload;
+
+		/**
+		 * Runs `rounds` of churn on each of `thread_count` threads.
+		 * Every round allocates a batch, stamps each object with its
+		 * owner and sequence, frees a random half, and hands a slice
+		 * to the next thread through a mailbox, so objects are also
+		 * freed on threads that did not allocate them. A stamp that
+		 * changed before its object was freed means two threads were
+		 * given the same slot; those are counted as errors.
+		 */
+		template <typename Allocate, typename Deallocate>
+		static size_t pool_stress_run(size_t thread_count, size_t rounds, size_t batch,
+			Allocate&& allocate, Deallocate&& deallocate)
+		{
+			typedef struct
+			{
+				std::mutex mutex;
+				// Each object with the stamp its sender gave it
+				std::vector<std::pair<StressPayload*, uint64_t>> objects;
+			} Mailbox;
+
+			std::vector<Mailbox> mailboxes(thread_count);
+			std::atomic<size_t> errors = 0;
+
+			auto check_and_free = [&](StressPayload* payload, uint64_t stamp)
+			{
+				if (payload->stamp != stamp)
+				{
+					errors.fetch_add(1, std::memory_order_relaxed);
+				}
+				payload->stamp = 0;
+				deallocate(payload);
+			};
+
+			std::vector<std::thread> threads;
+			for (size_t t = 0; t < thread_count; t++)
+			{
+				threads.emplace_back([&, t]()
+					{
+						std::mt19937 random((uint32_t)(1234 + t));
+						std::vector<StressPayload*> live;
+						std::vector<uint64_t> stamps;
+						std::vector<std::pair<StressPayload*, uint64_t>> received;
+						uint64_t sequence = 0;
+
+						for (size_t round = 0; round < rounds; round++)
+						{
+							for (size_t i = 0; i < batch; i++)
+							{
+								StressPayload* payload = allocate();
+								payload->stamp = ((uint64_t)t << 48) | ++sequence;
+								live.push_back(payload);
+								stamps.push_back(payload->stamp);
+							}
+
+							// Free a random half
+							for (size_t i = 0; i < live.size();)
+							{
+								if (random() & 1)
+								{
+									check_and_free(live[i], stamps[i]);
+									live[i] = live.back();
+									stamps[i] = stamps.back();
+									live.pop_back();
+									stamps.pop_back();
+								}
+								else
+								{
+									i++;
+								}
+							}
+
+							// Pass an eighth on to the next thread
+							Mailbox& next = mailboxes[(t + 1) % thread_count];
+							{
+								std::lock_guard<std::mutex> lock(next.mutex);
+								size_t send = live.size() / 8;
+								for (size_t i = 0; i < send; i++)
+								{
+									next.objects.emplace_back(live.back(), stamps.back());
+									live.pop_back();
+									stamps.pop_back();
+								}
+							}
+
+							received.clear();
+							{
+								std::lock_guard<std::mutex> lock(mailboxes[t].mutex);
+								received.swap(mailboxes[t].objects);
+							}
+							for (const auto& [payload, stamp] : received)
+							{
+								check_and_free(payload, stamp);
+							}
+						}
+
+						for (size_t i = 0; i < live.size(); i++)
+						{
+							check_and_free(live[i], stamps[i]);
+						}
+					});
+			}
+
+			for (std::thread& thread : threads)
+			{
+				thread.join();
+			}
+
+			// Objects still in transit when their receiver finished
+			for (Mailbox& mailbox : mailboxes)
+			{
+				for (const auto& [payload, stamp] : mailbox.objects)
+				{
+					check_and_free(payload, stamp);
+				}
+			}
+
+			return errors;
+		}
+
+		/**
+		 * Many threads allocating and freeing at once: the concurrent
+		 * pool against a PoolAllocator behind one mutex and the heap.
+		 */
+		static void pool_stress(const Context& context)
+		{
+			const size_t thread_count = std::clamp<size_t>(std::thread::hardware_concurrency(), 2, 16);
+			const size_t rounds = context.quick ? 200 : 2000;
+			const size_t batch = 256;
+			const size_t items = thread_count * rounds * batch;
+
+			std::vector<double> concurrent_ms;
+			std::vector<double> locked_ms;
+			std::vector<double> heap_ms;
+			size_t errors = 0;
+			size_t magazines = 0;
+			size_t blocks = 0;
+			for (int sample = 0; sample < context.samples; sample++)
+			{
+				{
+					ConcurrentPoolAllocator<StressPayload> pool(512);
+					concurrent_ms.push_back(time_ms([&]()
+						{
+							errors += pool_stress_run(thread_count, rounds, batch,
+								[&]() { return pool.allocate(); },
+								[&](StressPayload* payload) { pool.deallocate(payload); });
+						}));
+
+					// Everything was freed, so every slot is back in a magazine
+					for (StressPayload* payload : pool)
+					{
+						(void)payload;
+						errors++;
+					}
+					magazines = pool.get_magazine_count();
+					blocks = pool.get_block_count();
+				}
+
+				{
+					PoolAllocator<StressPayload> pool(512);
+					std::mutex mutex;
+					locked_ms.push_back(time_ms([&]()
+						{
+							errors += pool_stress_run(thread_count, rounds, batch,
+								[&]()
+								{
+									std::lock_guard<std::mutex> lock(mutex);
+									return pool.allocate();
+								},
+								[&](StressPayload* payload)
+								{
+									std::lock_guard<std::mutex> lock(mutex);
+									pool.deallocate(payload);
+								});
+						}));
+				}
+
+				heap_ms.push_back(time_ms([&]()
+					{
+						errors += pool_stress_run(thread_count, rounds, batch,
+							[]() { return new StressPayload(); },
+							[](StressPayload* payload) { delete payload; });
+					}));
+			}
+
+			nlohmann::json params = {{"threads", thread_count}, {"rounds", rounds}, {"batch", batch}, {"errors", errors}};
+			context.report("pool_stress_concurrent", params, concurrent_ms, items);
+			context.report("pool_stress_locked", params, locked_ms, items);
+			context.report("pool_stress_heap", params, heap_ms, items);
+
+			if (errors > 0)
+			{
+				char reason[128];
+				snprintf(reason, sizeof(reason), "%zu objects were handed out twice or leaked (%zu magazines, %zu blocks)",
+					errors, magazines, blocks);
+				context.fail("pool_stress", reason);
+			}
+		}
+
+		/**
+		 * One frame's worth of scratch: label strings too long for
+		 * the small string buffer and a short list, built and dropped
+		 * per item, from the frame arena and from the heap.
+		 */
+		static void frame_arena(const Context& context)
+		{
+			const size_t frames = context.quick ? 20 : 200;
+			const size_t items = 2000;
+
+			auto run_frame = [&](std::pmr::memory_resource* memory)
+			{
+				size_t total = 0;
+				for (size_t i = 0; i < items; i++)
+				{
+					std::pmr::string label("Object label that needs the heap #", memory);
+					label += std::to_string(i);
+
+					std::pmr::vector<uint32_t> indices(memory);
+					indices.reserve(16);
+					for (uint32_t j = 0; j < 16; j++)
+					{
+						indices.push_back(j);
+					}
+
+					total += label.size() + indices.size();
+				}
+				return total;
+			};
+
+			FrameArena arena(64 * 1024);
+			volatile size_t sink = 0;
+			std::vector<double> arena_ms;
+			std::vector<double> heap_ms;
+			for (int sample = 0; sample < context.samples; sample++)
+			{
+				arena_ms.push_back(time_ms([&]()
+					{
+						for (size_t frame = 0; frame < frames; frame++)
+						{
+							sink = run_frame(&arena);
+							arena.reset();
+						}
+					}));
+
+				heap_ms.push_back(time_ms([&]()
+					{
+						for (size_t frame = 0; frame < frames; frame++)
+						{
+							sink = run_frame(std::pmr::new_delete_resource());
+						}
+					}));
+			}
+			(void)sink;
+
+			nlohmann::json params = {{"frames", frames}, {"items", items},
+				{"peak_bytes", arena.get_high_water()}, {"capacity", arena.get_capacity()},
+				{"overflow_frames", arena.get_overflow_frames()}};
+			context.report("frame_arena", params, arena_ms, frames * items);
+			context.report("frame_heap", params, heap_ms, frames * items);
+		}
+
+		void register_memory_benchmarks(std::vector<Benchmark>& benchmarks)
+		{
+			benchmarks.push_back({"pool_churn", pool_churn});
+			benchmarks.push_back({"pool_iterate", pool_iterate});
+			benchmarks.push_back({"pool_stress", pool_stress});
+			benchmarks.push_back({"frame_arena", frame_arena});
+		}
+	} // namespace bench
+} // namespace bacon
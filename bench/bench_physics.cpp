@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <vector>
+
+#include "box2d/box2d.h"
+#include "nlohmann/json.hpp"
+
+#include "bench.h"
+#include "core/2D/entity_2d.h"
+#include "core/game_state.h"
+#include "core/job_system.h"
+
+namespace bacon
+{
+	namespace bench
+	{
+		static Entity2D* make_body(BodyType type, Vector2 position, Vector2 size)
+		{
+			nlohmann::json data;
+			data["position"] = {position.x, position.y};
+			data["size"] = {size.x, size.y};
+			data["is_visible"] = true;
+			data["body_type"] = type;
+			data["mass"] = 1.f;
+			data["density"] = 1.f;
+			data["friction"] = 0.6f;
+			data["gravity_scale"] = 1.f;
+
+			Entity2D* entity = new Entity2D();
+			entity->load_from_json(data);
+			entity->add_to_scene();
+			return entity;
+		}
+
+		/**
+		 * Scene2D::simulation_step on columns of boxes falling onto
+		 * a static floor, so contacts build up over the run.
+		 */
+		static void simulation_step(const Context& context)
+		{
+			std::vector<size_t> counts = {1000, 10000, 50000};
+			if (context.quick)
+			{
+				counts = {1000, 5000};
+			}
+
+			Scene2D* scene = GameState::state_2d->scene;
+			const float box_size = 16.f;
+			const float delta_time = 1.f / scene->physics_rate;
+
+			for (size_t count : counts)
+			{
+				scene->reset();
+
+				const size_t columns = count / 50;
+				const float width = columns * box_size * 1.5f;
+				make_body(BodyType::STATIC, {0.f, 200.f}, {width + 200.f, box_size});
+				for (size_t i = 0; i < count; i++)
+				{
+					float x = ((float)(i % columns) - columns * 0.5f) * box_size * 1.5f;
+					float y = 200.f - box_size * 2.f - (float)(i / columns) * box_size * 1.1f;
+					make_body(BodyType::DYNAMIC, {x, y}, {box_size, box_size});
+				}
+				scene->create_physics_bodies();
+
+				const int steps = (count >= 50000) ? 20 : 60;
+				std::vector<double> step_ms;
+				for (int i = 0; i < steps; i++)
+				{
+					step_ms.push_back(time_ms([&]()
+						{
+							scene->simulation_step(delta_time);
+						}));
+				}
+
+				context.report("simulation_step",
+					{
+						{"bodies", count},
+						{"workers", globals::job_system->get_worker_count()},
+					},
+					step_ms);
+			}
+		}
+
+		/**
+		 * Box2D step time for 1, 2, 4 and 8 workers, each with a
+		 * private job system hooked up the same way Scene2D does.
+		 * The world is body_count boxes piled in columns on a static
+		 * ground, with sleep disabled so every step does the same work.
+		 */
+		static void physics_workers(const Context& context)
+		{
+			const int body_count = context.quick ? 2000 : 10000;
+			const int step_count = context.quick ? 30 : 120;
+
+			const uint32_t worker_counts[] = {1, 2, 4, 8};
+			for (uint32_t worker_count : worker_counts)
+			{
+				JobSystem job_system(worker_count);
+
+				b2WorldDef world_def = b2DefaultWorldDef();
+				world_def.enableSleep = false;
+				world_def.workerCount = (int)job_system.get_worker_count();
+				world_def.enqueueTask = JobSystem::enqueue_box2d_task;
+				world_def.finishTask = JobSystem::finish_box2d_task;
+				world_def.userTaskContext = &job_system;
+				b2WorldId world = b2CreateWorld(&world_def);
+
+				const int columns = std::max(1, body_count / 40);
+
+				b2BodyDef ground_def = b2DefaultBodyDef();
+				b2BodyId ground = b2CreateBody(world, &ground_def);
+				b2Polygon ground_box = b2MakeBox(columns * 1.5f + 10.f, 1.f);
+				b2ShapeDef ground_shape = b2DefaultShapeDef();
+				b2CreatePolygonShape(ground, &ground_shape, &ground_box);
+
+				b2Polygon box = b2MakeBox(0.5f, 0.5f);
+				b2ShapeDef shape = b2DefaultShapeDef();
+				for (int i = 0; i < body_count; i++)
+				{
+					int column = i % columns;
+					int row = i / columns;
+
+					b2BodyDef body_def = b2DefaultBodyDef();
+					body_def.type = b2_dynamicBody;
+					body_def.position = {(column - columns * 0.5f) * 1.5f, 1.5f + row * 1.05f};
+					b2BodyId body = b2CreateBody(world, &body_def);
+					b2CreatePolygonShape(body, &shape, &box);
+				}
+
+				std::vector<double> step_ms;
+				for (int i = 0; i < step_count; i++)
+				{
+					step_ms.push_back(time_ms([&]()
+						{
+							b2World_Step(world, 1.f / 60.f, 4);
+						}));
+				}
+
+				b2DestroyWorld(world);
+
+				context.report("physics_workers",
+					{
+						{"workers", job_system.get_worker_count()},
+						{"bodies", body_count},
+					},
+					step_ms);
+			}
+		}
+
+		void register_physics_benchmarks(std::vector<Benchmark>& benchmarks)
+		{
+			benchmarks.push_back({"simulation_step", simulation_step});
+			benchmarks.push_back({"physics_workers", physics_workers});
+		}
+	} // namespace bench
+} // namespace bacon
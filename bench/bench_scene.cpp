@@ -0,0 +1,230 @@
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "core/2D/entity_2d.h"
+#include "core/game_state.h"
+
+namespace bacon
+{
+	namespace bench
+	{
+		static std::vector<Entity2D*> make_entities(size_t count)
+		{
+			std::vector<Entity2D*> entities;
+			entities.reserve(count);
+			for (size_t i = 0; i < count; i++)
+			{
+				Entity2D* entity = new Entity2D();
+				entity->set_position({(float)(i % 200) * 20.f, (float)(i / 200) * 20.f});
+				entity->set_size({16.f, 16.f});
+				entities.push_back(entity);
+			}
+			return entities;
+		}
+
+		/**
+		 * Adds and removes N entities at several scene sizes. The
+		 * ns_per_item of each size should stay flat as N grows,
+		 * since the scene swap-and-pops and the render layer only
+		 * leaves a hole to compact later.
+		 */
+		static void scene_add_remove(const Context& context)
+		{
+			std::vector<size_t> counts = {10000, 100000};
+			if (context.quick)
+			{
+				counts = {1000, 10000};
+			}
+
+			std::mt19937 random(1234);
+
+			for (size_t count : counts)
+			{
+				std::vector<double> add_ms;
+				std::vector<double> remove_ms;
+
+				for (int sample = 0; sample < context.samples; sample++)
+				{
+					std::vector<Entity2D*> entities = make_entities(count);
+
+					add_ms.push_back(time_ms([&]()
+						{
+							for (Entity2D* entity : entities)
+							{
+								entity->add_to_scene();
+							}
+						}));
+
+					// Remove in random order, like gameplay would
+					std::shuffle(entities.begin(), entities.end(), random);
+					remove_ms.push_back(time_ms([&]()
+						{
+							for (Entity2D* entity : entities)
+							{
+								entity->remove_from_scene();
+							}
+						}));
+
+					for (Entity2D* entity : entities)
+					{
+						delete entity;
+					}
+					GameState::state_2d->scene->reset();
+				}
+
+				context.report("scene_add", {{"count", count}}, add_ms, count);
+				context.report("scene_remove", {{"count", count}}, remove_ms, count);
+			}
+		}
+
+		static void scene_lookup(const Context& context)
+		{
+			const size_t count = context.quick ? 2000 : 20000;
+			Scene2D* scene = GameState::state_2d->scene;
+
+			std::vector<Entity2D*> entities = make_entities(count);
+			std::vector<UUID> uuids;
+			for (Entity2D* entity : entities)
+			{
+				entity->add_to_scene();
+				uuids.push_back(entity->get_uuid());
+			}
+			std::shuffle(uuids.begin(), uuids.end(), std::mt19937(1234));
+
+			std::vector<std::string> uuid_strings;
+			for (const UUID& uuid : uuids)
+			{
+				uuid_strings.push_back(uuid.as_string());
+			}
+
+			std::vector<double> uuid_ms;
+			std::vector<double> string_ms;
+			size_t found = 0;
+			for (int sample = 0; sample < context.samples; sample++)
+			{
+				uuid_ms.push_back(time_ms([&]()
+					{
+						for (const UUID& uuid : uuids)
+						{
+							found += scene->find_object_by_uuid(uuid) != nullptr;
+						}
+					}));
+
+				string_ms.push_back(time_ms([&]()
+					{
+						for (const std::string& uuid : uuid_strings)
+						{
+							found += scene->find_object_by_uuid(uuid) != nullptr;
+						}
+					}));
+			}
+
+			context.report("scene_lookup_uuid", {{"count", count}, {"found", found}}, uuid_ms, count);
+			context.report("scene_lookup_string", {{"count", count}}, string_ms, count);
+		}
+
+		static void scene_query(const Context& context)
+		{
+			const size_t count = context.quick ? 2000 : 20000;
+			Scene2D* scene = GameState::state_2d->scene;
+
+			std::vector<Entity2D*> entities = make_entities(count);
+			for (Entity2D* entity : entities)
+			{
+				entity->add_to_scene();
+			}
+
+			// 1280x720 view sliding across the scene
+			const int queries = 1000;
+			std::vector<Object2D*> results;
+			std::vector<double> query_ms;
+			std::vector<double> pick_ms;
+			for (int sample = 0; sample < context.samples; sample++)
+			{
+				query_ms.push_back(time_ms([&]()
+					{
+						for (int i = 0; i < queries; i++)
+						{
+							results.clear();
+							scene->query_objects({(float)(i * 3), (float)(i * 2), 1280.f, 720.f}, results);
+						}
+					}));
+
+				pick_ms.push_back(time_ms([&]()
+					{
+						for (int i = 0; i < queries; i++)
+						{
+							scene->pick_object({(float)(i * 4) + 8.f, (float)(i * 2) + 8.f});
+						}
+					}));
+			}
+
+			context.report("scene_query_view", {{"count", count}}, query_ms, queries);
+			context.report("scene_pick", {{"count", count}}, pick_ms, queries);
+		}
+
+		/**
+		 * Loads a level's worth of entities with names and tags long
+		 * enough to reach the heap, then unloads it with reset(),
+		 * once with members in the scene arena and once without.
+		 */
+		static void scene_load_unload(const Context& context)
+		{
+			const size_t count = context.quick ? 2000 : 20000;
+			Scene2D* scene = GameState::state_2d->scene;
+			const bool use_arena = scene->use_arena;
+
+			std::vector<std::string> names;
+			names.reserve(count);
+			for (size_t i = 0; i < count; i++)
+			{
+				names.push_back("Level entity number " + std::to_string(i));
+			}
+
+			for (bool arena : {false, true})
+			{
+				scene->use_arena = arena;
+
+				std::vector<double> load_ms;
+				std::vector<double> unload_ms;
+				for (int sample = 0; sample < context.samples; sample++)
+				{
+					load_ms.push_back(time_ms([&]()
+						{
+							ObjectMemoryScope scope(scene->get_object_memory());
+							for (size_t i = 0; i < count; i++)
+							{
+								Entity2D* entity = new Entity2D();
+								entity->set_name(names[i]);
+								entity->set_tag("level_geometry_static");
+								entity->set_position({(float)(i % 200) * 20.f, (float)(i / 200) * 20.f});
+								entity->set_size({16.f, 16.f});
+								entity->add_to_scene();
+							}
+						}));
+
+					unload_ms.push_back(time_ms([&]()
+						{
+							scene->reset();
+						}));
+				}
+
+				context.report("scene_load", {{"count", count}, {"arena", arena}}, load_ms, count);
+				context.report("scene_unload", {{"count", count}, {"arena", arena}}, unload_ms, count);
+			}
+
+			scene->use_arena = use_arena;
+		}
+
+		void register_scene_benchmarks(std::vector<Benchmark>& benchmarks)
+		{
+			benchmarks.push_back({"scene_add_remove", scene_add_remove});
+			benchmarks.push_back({"scene_lookup", scene_lookup});
+			benchmarks.push_back({"scene_query", scene_query});
+			benchmarks.push_back({"scene_load_unload", scene_load_unload});
+		}
+	} // namespace bench
+} // namespace bacon
@@ -0,0 +1,229 @@
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "core/2D/entity_2d.h"
+#include "core/game_state.h"
+#include "core/globals.h"
+#include "file/file.h"
+#include "file/project_loader.h"
+#include "lib/byte_stream.h"
+
+namespace bacon
+{
+	namespace bench
+	{
+		static void fill_scene(size_t count)
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				Entity2D* entity = new Entity2D();
+				entity->set_name("Entity " + std::to_string(i));
+				entity->set_position({(float)(i % 200) * 20.f, (float)(i / 200) * 20.f});
+				entity->set_size({16.f, 16.f});
+				entity->add_to_scene();
+			}
+		}
+
+		static void byte_stream(const Context& context)
+		{
+			const size_t count = context.quick ? 2000 : 20000;
+			fill_scene(count);
+
+			const std::vector<Object2D*>& objects = GameState::state_2d->scene->get_objects();
+			std::vector<ByteStream> streams;
+			streams.reserve(objects.size());
+
+			std::vector<double> serialize_ms;
+			std::vector<double> deserialize_ms;
+			size_t bytes = 0;
+			for (int sample = 0; sample < context.samples; sample++)
+			{
+				streams.clear();
+				serialize_ms.push_back(time_ms([&]()
+					{
+						for (Object2D* object : objects)
+						{
+							streams.push_back(object->serialize());
+						}
+					}));
+
+				std::vector<GameObject*> loaded;
+				loaded.reserve(streams.size());
+				deserialize_ms.push_back(time_ms([&]()
+					{
+						for (const ByteStream& stream : streams)
+						{
+							ByteView view = stream.view();
+							loaded.push_back(GameObject::create_game_object(view));
+						}
+					}));
+
+				bytes = 0;
+				for (const ByteStream& stream : streams)
+				{
+					bytes += stream.size();
+				}
+
+				for (GameObject* object : loaded)
+				{
+					delete object;
+				}
+			}
+
+			context.report("bytestream_serialize", {{"count", count}, {"bytes", bytes}}, serialize_ms, count);
+			context.report("bytestream_deserialize", {{"count", count}, {"bytes", bytes}}, deserialize_ms, count);
+		}
+
+		/**
+		 * One chain of nested entities, which used to be copied
+		 * once per level when serialized.
+		 */
+		static void deep_hierarchy(const Context& context)
+		{
+			const size_t depth = context.quick ? 64 : 512;
+
+			Entity2D* root = new Entity2D();
+			Entity2D* parent = root;
+			for (size_t i = 1; i < depth; i++)
+			{
+				Entity2D* child = new Entity2D();
+				child->set_name("Child " + std::to_string(i));
+				child->set_parent(parent);
+				parent = child;
+			}
+
+			std::vector<double> serialize_ms;
+			std::vector<double> deserialize_ms;
+			size_t bytes = 0;
+			for (int sample = 0; sample < context.samples; sample++)
+			{
+				ByteStream stream;
+				serialize_ms.push_back(time_ms([&]()
+					{
+						stream = root->serialize();
+					}));
+				bytes = stream.size();
+
+				GameObject* loaded = nullptr;
+				deserialize_ms.push_back(time_ms([&]()
+					{
+						ByteView view = stream.view();
+						loaded = GameObject::create_game_object(view);
+					}));
+
+				loaded->delete_children();
+				delete loaded;
+			}
+
+			root->delete_children();
+			delete root;
+
+			context.report("hierarchy_serialize", {{"depth", depth}, {"bytes", bytes}}, serialize_ms, depth);
+			context.report("hierarchy_deserialize", {{"depth", depth}, {"bytes", bytes}}, deserialize_ms, depth);
+		}
+
+		/**
+		 * Saves and reloads the same scene through one project
+		 * format, chosen by the file extension.
+		 */
+		static void project_round_trip(const Context& context, const std::string& format,
+			const std::string& extension)
+		{
+			const size_t count = context.quick ? 2000 : 20000;
+
+			std::string json_file = globals::project_file;
+			globals::project_file = std::filesystem::path(json_file).replace_extension(extension).generic_string();
+
+			std::vector<double> save_ms;
+			std::vector<double> load_ms;
+			for (int sample = 0; sample < context.samples; sample++)
+			{
+				GameState::state_2d->scene->reset();
+				fill_scene(count);
+
+				save_ms.push_back(time_ms([]()
+					{
+						file::save_project();
+					}));
+
+				load_ms.push_back(time_ms([]()
+					{
+						file::load_project(false);
+					}));
+			}
+
+			size_t bytes = std::filesystem::file_size(globals::project_file);
+			globals::project_file = json_file;
+
+			context.report(format + "_project_save", {{"count", count}, {"bytes", bytes}}, save_ms, count);
+			context.report(format + "_project_load", {{"count", count}, {"bytes", bytes}}, load_ms, count);
+		}
+
+		static void json_project(const Context& context)
+		{
+			project_round_trip(context, "json", ".json");
+		}
+
+		static void bproj_project(const Context& context)
+		{
+			project_round_trip(context, "bproj", ".bproj");
+		}
+
+		/**
+		 * Frame hitch of loading a project in one call versus
+		 * streaming it with ProjectLoader's default budget.
+		 */
+		static void streaming_load(const Context& context)
+		{
+			const size_t count = context.quick ? 2000 : 20000;
+
+			GameState::state_2d->scene->reset();
+			fill_scene(count);
+			file::save_project();
+
+			std::vector<double> blocking_ms;
+			std::vector<double> longest_update_ms;
+			std::vector<double> total_ms;
+			size_t frames = 0;
+			for (int sample = 0; sample < context.samples; sample++)
+			{
+				blocking_ms.push_back(time_ms([]()
+					{
+						file::load_project(false);
+					}));
+
+				ProjectLoader loader;
+				double longest = 0.0;
+				frames = 0;
+				total_ms.push_back(time_ms([&]()
+					{
+						loader.begin(globals::project_file);
+						while (loader.is_loading())
+						{
+							longest = std::max(longest, time_ms([&]()
+								{
+									loader.update();
+								}));
+							frames++;
+						}
+					}));
+				longest_update_ms.push_back(longest);
+			}
+
+			context.report("project_load_blocking", {{"count", count}}, blocking_ms, count);
+			context.report("project_load_streaming_total", {{"count", count}, {"frames", frames}}, total_ms, count);
+			context.report("project_load_streaming_longest_frame", {{"count", count}, {"frames", frames}}, longest_update_ms);
+		}
+
+		void register_serialization_benchmarks(std::vector<Benchmark>& benchmarks)
+		{
+			benchmarks.push_back({"byte_stream", byte_stream});
+			benchmarks.push_back({"deep_hierarchy", deep_hierarchy});
+			benchmarks.push_back({"json_project", json_project});
+			benchmarks.push_back({"bproj_project", bproj_project});
+			benchmarks.push_back({"streaming_load", streaming_load});
+		}
+	} // namespace bench
+} // namespace bacon
@@ -0,0 +1,138 @@
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "raylib.h"
+
+#include "bench.h"
+#include "core/2D/text_object.h"
+
+namespace bacon
+{
+	namespace bench
+	{
+		static const char* _PARAGRAPH =
+			"The quick brown fox jumps over the lazy dog while the engine "
+			"wraps this sentence again and again to see how long it takes. "
+			"Supercalifragilisticexpialidocious words force a character split. ";
+
+		/**
+		 * TextObject::set_text re-measures and re-wraps the text,
+		 * which runs wrap_text for anything wider than the box.
+		 */
+		static void text_wrap(const Context& context)
+		{
+			if (!IsWindowReady())
+			{
+				context.skip("text_wrap", "no window for font metrics");
+				return;
+			}
+
+			const int repeats[] = {1, 10, 50};
+			for (int repeat : repeats)
+			{
+				std::string text;
+				for (int i = 0; i < repeat; i++)
+				{
+					text += _PARAGRAPH;
+				}
+
+				TextObject text_object;
+				text_object.set_size({300.f, 1000.f});
+				text_object.set_font_size(20);
+
+				const int iterations = context.quick ? 20 : 100;
+				std::vector<double> wrap_ms;
+				for (int sample = 0; sample < context.samples; sample++)
+				{
+					wrap_ms.push_back(time_ms([&]()
+						{
+							for (int i = 0; i < iterations; i++)
+							{
+								// Alternate so every call does the full work
+								text_object.set_text((i & 1) ? text : text + " ");
+							}
+						}));
+				}
+
+				context.report("text_wrap", {{"chars", text.size()}}, wrap_ms, iterations);
+			}
+		}
+
+		/**
+		 * Drawing a set of unchanging text objects: DrawTextPro over
+		 * the string every frame versus TextObject's cached quads.
+		 */
+		static void text_draw(const Context& context)
+		{
+			if (!IsWindowReady())
+			{
+				context.skip("text_draw", "no window to draw into");
+				return;
+			}
+
+			const size_t count = context.quick ? 50 : 200;
+			std::vector<TextObject*> objects;
+			for (size_t i = 0; i < count; i++)
+			{
+				TextObject* text_object = new TextObject();
+				text_object->set_size({300.f, 1000.f});
+				text_object->set_font_size(20);
+				text_object->set_text(_PARAGRAPH);
+				text_object->set_position({(float)(i % 10) * 100.f, (float)(i / 10) * 40.f});
+				objects.push_back(text_object);
+			}
+
+			RenderTexture2D target = LoadRenderTexture(1024, 1024);
+			const int frames = context.quick ? 10 : 50;
+
+			std::vector<double> immediate_ms;
+			std::vector<double> cached_ms;
+			for (int sample = 0; sample < context.samples; sample++)
+			{
+				immediate_ms.push_back(time_ms([&]()
+					{
+						for (int frame = 0; frame < frames; frame++)
+						{
+							BeginTextureMode(target);
+							for (TextObject* text_object : objects)
+							{
+								DrawTextPro(GetFontDefault(), _PARAGRAPH, text_object->get_position(),
+									{0.f, 0.f}, 0.f, 20.f, 0.f, BLACK);
+							}
+							EndTextureMode();
+						}
+					}));
+
+				cached_ms.push_back(time_ms([&]()
+					{
+						for (int frame = 0; frame < frames; frame++)
+						{
+							BeginTextureMode(target);
+							for (TextObject* text_object : objects)
+							{
+								text_object->draw();
+							}
+							EndTextureMode();
+						}
+					}));
+			}
+
+			UnloadRenderTexture(target);
+			for (TextObject* text_object : objects)
+			{
+				delete text_object;
+			}
+
+			nlohmann::json params = {{"objects", count}, {"chars", strlen(_PARAGRAPH)}};
+			context.report("text_draw_immediate", params, immediate_ms, frames);
+			context.report("text_draw_cached", params, cached_ms, frames);
+		}
+
+		void register_text_benchmarks(std::vector<Benchmark>& benchmarks)
+		{
+			benchmarks.push_back({"text_wrap", text_wrap});
+			benchmarks.push_back({"text_draw", text_draw});
+		}
+	} // namespace bench
+} // namespace bacon
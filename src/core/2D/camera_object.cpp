@@ -10,11 +10,11 @@
 #include "editor/editor_event.h"
 #include "editor/ui/editor_ui.h"
 #include "editor/ui/imgui_extras.h"
-#include "lib/pool_allocator.h"
+#include "lib/concurrent_pool_allocator.h"
 
 namespace bacon
 {
-	PoolAllocator<CameraObject> CameraObject::_allocator(globals::allocator_block_size);
+	ConcurrentPoolAllocator<CameraObject> CameraObject::_allocator(globals::allocator_block_size);
 
 	void* CameraObject::operator new(size_t size)
 	{
@@ -49,7 +49,7 @@ namespace bacon
 		set_size({0, 0});
 	}
 
-	CameraObject::CameraObject(ByteStream& bytes) : Object2D()
+	CameraObject::CameraObject(ByteView& bytes) : Object2D()
 	{
 		m_type_id = TypeID::CAMERA_2D;
 		deserialize(bytes);
@@ -90,7 +90,10 @@ namespace bacon
 		if (get_in_scene()) return;
 
 		GameState::state_2d->scene->add_camera(this);
-		GameState::state_2d->renderer->add_to_layer(this, get_layer());
+		if (GameState::state_2d->renderer != nullptr)
+		{
+			GameState::state_2d->renderer->add_to_layer(this, get_layer());
+		}
 		set_in_scene(true);
 
 		add_children_to_scene();
@@ -101,7 +104,10 @@ namespace bacon
 		if (!get_in_scene()) return;
 
 		GameState::state_2d->scene->remove_camera(this);
-		GameState::state_2d->renderer->remove_from_layer(this);
+		if (GameState::state_2d->renderer != nullptr)
+		{
+			GameState::state_2d->renderer->remove_from_layer(this);
+		}
 		set_in_scene(false);
 
 		remove_children_from_scene();
@@ -197,7 +203,10 @@ namespace bacon
 			ui::properties_changes_made = true;
 		}
 		// ImGui::SameLine();
-		ImGui::HelpMarker("ID: " + get_uuid().as_string());
+		// Rebuilt every frame, so it lives in the frame arena
+		std::pmr::string id("ID: ", globals::frame_memory());
+		id += get_uuid().as_string(globals::frame_memory());
+		ImGui::HelpMarker(id);
 
 		// Tag
 		ImGui::ItemLabel("Tag", ItemLabelFlag::Left);
@@ -286,17 +295,15 @@ namespace bacon
 		camera.zoom = this->zoom;
 	}
 
-	ByteStream CameraObject::serialize() const
+	void CameraObject::serialize_to(ByteStream& bytes) const
 	{
-		ByteStream bytes = Object2D::serialize();
+		Object2D::serialize_to(bytes);
 
 		bytes << this->is_active;
 		bytes << this->zoom;
-
-		return bytes;
 	}
 
-	void CameraObject::deserialize(ByteStream& bytes)
+	void CameraObject::deserialize(ByteView& bytes)
 	{
 		Object2D::deserialize(bytes);
 
@@ -1,14 +1,14 @@
 #pragma once
 
 #include "core/2D/object_2d.h"
-#include "lib/pool_allocator.h"
+#include "lib/concurrent_pool_allocator.h"
 
 namespace bacon
 {
 	class CameraObject : public Object2D
 	{
 	public:
-		static PoolAllocator<CameraObject> _allocator;
+		static ConcurrentPoolAllocator<CameraObject> _allocator;
 		static void* operator new(size_t size);
 		static void* operator new(size_t size, void* ptr);
 		static void operator delete(void* ptr);
@@ -25,7 +25,7 @@ namespace bacon
 		float zoom;
 
 		CameraObject();
-		CameraObject(ByteStream& bytes);
+		CameraObject(ByteView& bytes);
 		CameraObject(const CameraObject& camera);
 		CameraObject& operator=(const CameraObject& camera) = delete;
 		CameraObject(CameraObject&& camera) = delete;
@@ -52,9 +52,9 @@ namespace bacon
 		void draw_properties_editor() override;
 		void save_to_json(nlohmann::json& data) const override;
 		void load_from_json(const nlohmann::json& data) override;
-		ByteStream serialize() const override;
+		void serialize_to(ByteStream& bytes) const override;
 
 	protected:
-		void deserialize(ByteStream& bytes) override;
+		void deserialize(ByteView& bytes) override;
 	};
 } // namespace bacon
@@ -12,6 +12,7 @@
 #include "nlohmann/detail/value_t.hpp"
 #include "raylib.h"
 #include "raymath.h"
+#include "rlgl.h"
 
 #include "core/game_state.h"
 #include "core/globals.h"
@@ -23,7 +24,7 @@
 
 namespace bacon
 {
-	PoolAllocator<Entity2D> Entity2D::_allocator(globals::allocator_block_size);
+	ConcurrentPoolAllocator<Entity2D> Entity2D::_allocator(globals::allocator_block_size);
 
 	void* Entity2D::operator new(size_t size)
 	{
@@ -51,6 +52,7 @@ namespace bacon
 		set_name("Entity");
 
 		m_texture = {0};
+		m_source_rect = {0, 0, 0, 0};
 		m_texture_path = "";
 
 		m_physics_body = {0};
@@ -74,7 +76,7 @@ namespace bacon
 		};
 	}
 
-	Entity2D::Entity2D(ByteStream& bytes) : Object2D()
+	Entity2D::Entity2D(ByteView& bytes) : Object2D()
 	{
 		m_type_id = TypeID::ENTITY_2D;
 		deserialize(bytes);
@@ -104,13 +106,13 @@ namespace bacon
 		const Entity2D& entity = static_cast<const Entity2D&>(object);
 
 		this->m_physics_properties = entity.m_physics_properties;
-		this->set_texture(entity.m_texture_path);
+		this->set_texture(std::string(entity.m_texture_path));
 
 		m_lua_variables = entity.m_lua_variables;
-		for (const std::string& path : entity.m_lua_script_paths)
+		for (const std::pmr::string& path : entity.m_lua_script_paths)
 		{
 			// Adds path to list and creates script object
-			load_lua_script(path);
+			load_lua_script(std::string(path));
 		}
 	}
 
@@ -132,7 +134,10 @@ namespace bacon
 		if (get_in_scene()) return;
 
 		GameState::state_2d->scene->add_entity(this);
-		GameState::state_2d->renderer->add_to_layer(this, get_layer());
+		if (GameState::state_2d->renderer != nullptr)
+		{
+			GameState::state_2d->renderer->add_to_layer(this, get_layer());
+		}
 		set_in_scene(true);
 
 		add_children_to_scene();
@@ -152,6 +157,7 @@ namespace bacon
 		if (path.length() <= 0)
 		{
 			m_texture = nullptr;
+			m_source_rect = {0, 0, 0, 0};
 			m_texture_path = "";
 			return;
 		}
@@ -159,8 +165,24 @@ namespace bacon
 		m_texture_path = path;
 		if (GameState::state_2d != nullptr && GameState::state_2d->assets != nullptr)
 		{
-			m_texture = GameState::state_2d->assets->load_texture(path);
+			TextureRegion region = GameState::state_2d->assets->load_texture_region_async(path);
+			m_texture = region.texture;
+			m_source_rect = region.source;
+		}
+	}
+
+	/**
+	 * Part of the texture to draw. An empty rect means the whole
+	 * texture, whose size isn't known until an async load finishes.
+	 */
+	Rectangle Entity2D::get_source_rect() const
+	{
+		if (m_source_rect.width == 0.f && m_texture != nullptr)
+		{
+			return {0.f, 0.f, (float)m_texture->width, (float)m_texture->height};
 		}
+
+		return m_source_rect;
 	}
 
 	void Entity2D::create_body(b2WorldId world_id)
@@ -209,6 +231,8 @@ namespace bacon
 		};
 		body_def.isBullet = m_physics_properties.is_bullet;
 		body_def.isEnabled = !m_physics_properties.disabled;
+		// Lets Scene2D map body move events back to the entity
+		body_def.userData = this;
 
 		b2MassData mass_data;
 		mass_data.mass = m_physics_properties.mass;
@@ -244,19 +268,18 @@ namespace bacon
 			return;
 		}
 
-		m_lua_script_paths.push_back(path);
+		m_lua_script_paths.emplace_back(path);
 		m_lua_script_objects.push_back(result);
 	}
 
 	void Entity2D::create_lua_variable(const std::string& name, const LuaVar& var)
 	{
-		// m_lua_variables[name] = var;
-		m_lua_variables.emplace(std::pair(name, var));
+		m_lua_variables.emplace(name, var);
 	}
 
 	LuaVar* Entity2D::get_lua_variable(const std::string& name)
 	{
-		auto variable = m_lua_variables.find(name);
+		auto variable = m_lua_variables.find(std::string_view(name));
 		if (variable == m_lua_variables.end())
 		{
 			return nullptr;
@@ -265,6 +288,19 @@ namespace bacon
 		return &(variable->second);
 	}
 
+	// Adds the variable or overwrites an existing one of that name
+	void Entity2D::set_lua_variable(std::string_view name, const LuaVar& var)
+	{
+		auto variable = m_lua_variables.find(name);
+		if (variable != m_lua_variables.end())
+		{
+			variable->second = var;
+			return;
+		}
+
+		m_lua_variables.emplace(name, var);
+	}
+
 	void Entity2D::update_ui_buffer() const
 	{
 		Object2D::update_ui_buffer();
@@ -342,7 +378,7 @@ namespace bacon
 		{
 			DrawTexturePro(
 				*m_texture,
-				(Rectangle){0, 0, (float)m_texture->width, (float)m_texture->height},
+				get_source_rect(),
 				(Rectangle){draw_pos.x, draw_pos.y, draw_size.x, draw_size.y},
 				{draw_size.x * 0.5f, draw_size.y * 0.5f},
 				draw_rot,
@@ -350,6 +386,66 @@ namespace bacon
 		}
 	}
 
+	/**
+	 * Emits this entity's textured quad into the current rlgl batch.
+	 * The caller binds the texture and wraps calls in rlBegin(RL_QUADS),
+	 * so many entities sharing a texture become one draw call.
+	 */
+	void Entity2D::draw_quad() const
+	{
+		Vector2 position;
+		float rotation;
+		get_world_transform(&position, &rotation);
+
+		Vector2 size = get_size();
+		float radians = rotation * DEG2RAD;
+		float cosr = cosf(radians);
+		float sinr = sinf(radians);
+
+		// Corners relative to the center, rotated about it
+		float dx = -size.x * 0.5f;
+		float dy = -size.y * 0.5f;
+		Vector2 top_left = {
+			position.x + dx * cosr - dy * sinr,
+			position.y + dx * sinr + dy * cosr,
+		};
+		Vector2 top_right = {
+			position.x + (dx + size.x) * cosr - dy * sinr,
+			position.y + (dx + size.x) * sinr + dy * cosr,
+		};
+		Vector2 bottom_left = {
+			position.x + dx * cosr - (dy + size.y) * sinr,
+			position.y + dx * sinr + (dy + size.y) * cosr,
+		};
+		Vector2 bottom_right = {
+			position.x + (dx + size.x) * cosr - (dy + size.y) * sinr,
+			position.y + (dx + size.x) * sinr + (dy + size.y) * cosr,
+		};
+
+		Rectangle source = get_source_rect();
+		float texture_width = (float)m_texture->width;
+		float texture_height = (float)m_texture->height;
+		float u0 = source.x / texture_width;
+		float v0 = source.y / texture_height;
+		float u1 = (source.x + source.width) / texture_width;
+		float v1 = (source.y + source.height) / texture_height;
+
+		rlColor4ub(WHITE.r, WHITE.g, WHITE.b, WHITE.a);
+		rlNormal3f(0.f, 0.f, 1.f);
+
+		rlTexCoord2f(u0, v0);
+		rlVertex2f(top_left.x, top_left.y);
+
+		rlTexCoord2f(u0, v1);
+		rlVertex2f(bottom_left.x, bottom_left.y);
+
+		rlTexCoord2f(u1, v1);
+		rlVertex2f(bottom_right.x, bottom_right.y);
+
+		rlTexCoord2f(u1, v0);
+		rlVertex2f(top_right.x, top_right.y);
+	}
+
 	void Entity2D::draw_properties_editor()
 	{
 		// WARNING!!
@@ -513,7 +609,7 @@ namespace bacon
 			{
 				for (auto it = m_lua_variables.begin(); it != m_lua_variables.end(); ++it)
 				{
-					const std::string& var_name = it->first;
+					std::string_view var_name = it->first;
 					LuaVar& variable = it->second;
 
 					ImGui::ItemLabel(var_name, ItemLabelFlag::Left);
@@ -587,7 +683,7 @@ namespace bacon
 					LuaVar new_variable;
 					new_variable.type = var_type;
 
-					m_lua_variables.emplace(std::pair(variable_name, new_variable));
+					m_lua_variables.emplace(variable_name, new_variable);
 					variable_name = "";
 
 					globals::has_unsaved_changes = true;
@@ -612,7 +708,7 @@ namespace bacon
 	{
 		Object2D::save_to_json(data);
 
-		data["texture_path"] = m_texture_path;
+		data["texture_path"] = std::string(m_texture_path);
 
 		data["body_type"] = m_physics_properties.type;
 		data["body_center"] = m_physics_properties.body_center;
@@ -629,7 +725,7 @@ namespace bacon
 
 		for (auto it = m_lua_variables.begin(); it != m_lua_variables.end(); ++it)
 		{
-			const std::string& var_name = it->first;
+			const std::string var_name(it->first);
 			const LuaVar& variable = it->second;
 
 			switch (variable.type)
@@ -676,8 +772,7 @@ namespace bacon
 	{
 		Object2D::load_from_json(data);
 
-		m_texture_path = json_read_string(data, "texture_path");
-		set_texture(m_texture_path);
+		set_texture(json_read_string(data, "texture_path"));
 
 		m_physics_properties.type = BodyType(json_read_uint8(data, "body_type"));
 		Vector2 body_center = json_read_vector2(data, "body_center");
@@ -730,14 +825,14 @@ namespace bacon
 					default:
 						break;
 				}
-				m_lua_variables[var_name] = new_variable;
+				set_lua_variable(var_name, new_variable);
 			}
 		}
 	}
 
-	ByteStream Entity2D::serialize() const
+	void Entity2D::serialize_to(ByteStream& bytes) const
 	{
-		ByteStream bytes = Object2D::serialize();
+		Object2D::serialize_to(bytes);
 
 		bytes << m_texture_path;
 		bytes << static_cast<uint8_t>(m_physics_properties.type);
@@ -756,10 +851,38 @@ namespace bacon
 		bytes << m_physics_properties.fixed_rotation;
 		bytes << m_physics_properties.is_bullet;
 
-		return bytes;
+		bytes << (uint32_t)m_lua_variables.size();
+		for (auto it = m_lua_variables.begin(); it != m_lua_variables.end(); ++it)
+		{
+			const LuaVar& variable = it->second;
+
+			bytes << it->first;
+			bytes << static_cast<uint8_t>(variable.type);
+			switch (variable.type)
+			{
+				case LuaVar_t::BOOL:
+					bytes << variable.bool_val;
+					break;
+
+				case LuaVar_t::INT:
+					bytes << variable.int_val;
+					break;
+
+				case LuaVar_t::FLOAT:
+					bytes << variable.float_val;
+					break;
+
+				case LuaVar_t::STRING:
+					bytes << variable.str_val;
+					break;
+
+				default:
+					break;
+			}
+		}
 	}
 
-	void Entity2D::deserialize(ByteStream& bytes)
+	void Entity2D::deserialize(ByteView& bytes)
 	{
 		Object2D::deserialize(bytes);
 
@@ -785,5 +908,42 @@ namespace bacon
 		bytes >> m_physics_properties.disabled;
 		bytes >> m_physics_properties.fixed_rotation;
 		bytes >> m_physics_properties.is_bullet;
+
+		uint32_t variable_count = read_uint32(bytes);
+		for (uint32_t i = 0; i < variable_count; i++)
+		{
+			std::string_view var_name = bytes.read_string_view();
+
+			LuaVar new_variable;
+			new_variable.type = static_cast<LuaVar_t>(read_uint8(bytes));
+			switch (new_variable.type)
+			{
+				case LuaVar_t::BOOL:
+					bytes >> new_variable.bool_val;
+					break;
+
+				case LuaVar_t::INT:
+					bytes >> new_variable.int_val;
+					break;
+
+				case LuaVar_t::FLOAT:
+					bytes >> new_variable.float_val;
+					break;
+
+				case LuaVar_t::STRING:
+					bytes >> new_variable.str_val;
+					break;
+
+				// Written without a payload
+				case LuaVar_t::NONE:
+					continue;
+
+				// Its payload size is unknown, so nothing after it
+				// can be read. Fail the object like a truncated one.
+				default:
+					throw std::out_of_range("Entity2D: unknown Lua variable type");
+			}
+			set_lua_variable(var_name, new_variable);
+		}
 	}
 } // namespace bacon
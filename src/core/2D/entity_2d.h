@@ -1,13 +1,19 @@
 #pragma once
 
+#include <functional>
+#include <memory_resource>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 #include "box2d/id.h"
 #include "raylib.h"
 
 #include "core/2D/object_2d.h"
 #include "core/lua_api.h"
-#include "lib/pool_allocator.h"
+#include "lib/concurrent_pool_allocator.h"
+#include "lib/hash.h"
 
 namespace bacon
 {
@@ -40,7 +46,7 @@ namespace bacon
 	class Entity2D : public Object2D
 	{
 	public:
-		static PoolAllocator<Entity2D> _allocator;
+		static ConcurrentPoolAllocator<Entity2D> _allocator;
 		static void* operator new(size_t size);
 		static void* operator new(size_t size, void* ptr);
 		static void operator delete(void* ptr);
@@ -53,7 +59,7 @@ namespace bacon
 		static constexpr TypeID static_type_id = TypeID::ENTITY_2D;
 
 		Entity2D();
-		Entity2D(ByteStream& bytes);
+		Entity2D(ByteView& bytes);
 		Entity2D(const Entity2D& Entity2D);
 		Entity2D& operator=(const Entity2D& Entity2D) = delete;
 		Entity2D(Entity2D&& Entity2D) = delete;
@@ -69,7 +75,9 @@ namespace bacon
 		void remove_from_scene() override;
 
 		void set_texture(const std::string& path);
-		std::string get_texture_path() const { return m_texture_path; }
+		std::string get_texture_path() const { return std::string(m_texture_path); }
+		const Texture2D* get_texture() const { return m_texture.get(); }
+		Rectangle get_source_rect() const;
 
 		b2BodyId get_body_id() const { return m_physics_body; }
 		b2ShapeId get_shape_id() const { return m_physics_shape; }
@@ -85,23 +93,32 @@ namespace bacon
 		void update_from_ui_buffer() override;
 
 		void draw() const override;
+		void draw_quad() const;
 		void draw_properties_editor() override;
 		void save_to_json(nlohmann::json& data) const override;
 		void load_from_json(const nlohmann::json& data) override;
-		ByteStream serialize() const override;
+		void serialize_to(ByteStream& bytes) const override;
 
 	protected:
-		void deserialize(ByteStream& bytes) override;
+		void deserialize(ByteView& bytes) override;
 
 	private:
 		std::shared_ptr<Texture2D> m_texture;
-		std::string m_texture_path;
+		// Region of m_texture to draw (a sprite atlas cell or the whole texture)
+		Rectangle m_source_rect;
+		std::pmr::string m_texture_path{ObjectMemoryScope::current()};
 		b2BodyId m_physics_body;
 		b2ShapeId m_physics_shape;
 		PhysicsProperties m_physics_properties;
 
-		std::vector<std::string> m_lua_script_paths;
-		std::vector<sol::protected_function> m_lua_script_objects;
-		std::unordered_map<std::string, LuaVar> m_lua_variables;
+		std::pmr::vector<std::pmr::string> m_lua_script_paths{ObjectMemoryScope::current()};
+		// Not braced: sol's converting constructors would take the
+		// resource as an element
+		std::pmr::vector<sol::protected_function> m_lua_script_objects =
+			std::pmr::vector<sol::protected_function>(ObjectMemoryScope::current());
+		std::pmr::unordered_map<std::pmr::string, LuaVar, StringHash, std::equal_to<>> m_lua_variables{
+			ObjectMemoryScope::current()};
+
+		void set_lua_variable(std::string_view name, const LuaVar& var);
 	};
 } // namespace bacon
@@ -1,12 +1,14 @@
 #include "core/2D/game_state_2d.h"
 
+#include "core/2D/text_object.h"
+
 namespace bacon
 {
-	GameState2D::GameState2D()
+	GameState2D::GameState2D(bool headless)
 	{
-		assets = new AssetManager2D();
+		assets = new AssetManager2D(headless);
 		scene = new Scene2D();
-		renderer = new Renderer2D(800, 600);
+		renderer = headless ? nullptr : new Renderer2D(800, 600);
 	}
 
 	GameState2D::~GameState2D()
@@ -14,6 +16,27 @@ namespace bacon
 		cleanup();
 	}
 
+	/**
+	 * Finishes asynchronous asset loads. Text is re-laid out once
+	 * its real font replaces the placeholder; every live TextObject
+	 * is visited, including copies outside the scene.
+	 */
+	void GameState2D::update_assets()
+	{
+		assets->update();
+
+		for (const std::string& path : assets->get_loaded_fonts())
+		{
+			for (TextObject* text : TextObject::_allocator)
+			{
+				if (text->get_font_path() == path)
+				{
+					text->set_font(path);
+				}
+			}
+		}
+	}
+
 	void GameState2D::cleanup()
 	{
 		delete assets;
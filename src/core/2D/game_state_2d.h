@@ -13,9 +13,11 @@ namespace bacon
 		Scene2D* scene;
 		Renderer2D* renderer;
 
-		GameState2D();
+		// Headless states have no renderer and never touch the GPU
+		GameState2D(bool headless = false);
 		~GameState2D();
 
+		void update_assets();
 		void cleanup();
 	};
 }
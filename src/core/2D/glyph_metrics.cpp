@@ -0,0 +1,171 @@
+#include "core/2D/glyph_metrics.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <tuple>
+
+namespace bacon
+{
+	// Font identity (glyph data, texture) plus size and spacing
+	typedef std::tuple<const GlyphInfo*, unsigned int, int, float, float> MetricsKey;
+
+	typedef struct
+	{
+		GlyphMetrics metrics;
+		// get_tables_clock() value of the last get() that returned it
+		uint64_t last_used;
+	} MetricsEntry;
+
+	static std::map<MetricsKey, MetricsEntry>& get_tables()
+	{
+		static std::map<MetricsKey, MetricsEntry> tables;
+		return tables;
+	}
+
+	static uint64_t& get_tables_clock()
+	{
+		static uint64_t clock = 0;
+		return clock;
+	}
+
+	/**
+	 * Returns the table for the font at this size and spacing.
+	 * At most _MAX_TABLES are kept; building one more evicts the
+	 * least recently used. The reference is only valid until the
+	 * next get() or forget(), so don't hold on to it.
+	 */
+	const GlyphMetrics& GlyphMetrics::get(const Font& font, float font_size, float spacing)
+	{
+		std::map<MetricsKey, MetricsEntry>& tables = get_tables();
+		uint64_t& clock = get_tables_clock();
+		MetricsKey key = {font.glyphs, font.texture.id, font.glyphCount, font_size, spacing};
+
+		auto it = tables.find(key);
+		if (it == tables.end())
+		{
+			if (tables.size() >= _MAX_TABLES)
+			{
+				// Tables are rebuilt rarely, so a linear scan
+				// beats keeping a separate recency list
+				auto oldest = std::min_element(tables.begin(), tables.end(),
+					[](const auto& a, const auto& b) { return a.second.last_used < b.second.last_used; });
+				tables.erase(oldest);
+			}
+
+			it = tables.emplace(key, MetricsEntry{GlyphMetrics(font, font_size, spacing), 0}).first;
+		}
+
+		it->second.last_used = ++clock;
+		return it->second.metrics;
+	}
+
+	void GlyphMetrics::forget(const Font& font)
+	{
+		std::map<MetricsKey, MetricsEntry>& tables = get_tables();
+		for (auto it = tables.begin(); it != tables.end();)
+		{
+			if (std::get<0>(it->first) == font.glyphs)
+			{
+				it = tables.erase(it);
+			}
+			else
+			{
+				it++;
+			}
+		}
+	}
+
+	/**
+	 * Mirrors MeasureTextEx's per-glyph width: the advance, or the
+	 * glyph's extent when the font gives no advance.
+	 */
+	GlyphMetrics::GlyphMetrics(const Font& font, float font_size, float spacing)
+	{
+		m_spacing = spacing;
+		m_empty = font.glyphs == nullptr || font.baseSize <= 0;
+		if (m_empty)
+		{
+			return;
+		}
+
+		const float scale = font_size / (float)font.baseSize;
+		bool present[_ASCII_COUNT] = {};
+		int fallback_index = 0;
+		for (int i = 0; i < font.glyphCount; i++)
+		{
+			const GlyphInfo& glyph = font.glyphs[i];
+			float width = (glyph.advanceX != 0) ? (float)glyph.advanceX
+				: font.recs[i].width + (float)glyph.offsetX;
+			float advance = width * scale + spacing;
+
+			if (glyph.value >= 0 && glyph.value < _ASCII_COUNT)
+			{
+				m_ascii[glyph.value] = advance;
+				present[glyph.value] = true;
+			}
+			else
+			{
+				m_advances.emplace(glyph.value, advance);
+			}
+
+			if (glyph.value == '?')
+			{
+				fallback_index = i;
+			}
+		}
+
+		const GlyphInfo& fallback = font.glyphs[fallback_index];
+		m_fallback = ((fallback.advanceX != 0) ? (float)fallback.advanceX
+			: font.recs[fallback_index].width + (float)fallback.offsetX) * scale + spacing;
+
+		// ASCII the font lacks draws as the fallback glyph
+		for (int codepoint = 0; codepoint < _ASCII_COUNT; codepoint++)
+		{
+			if (!present[codepoint])
+			{
+				m_ascii[codepoint] = m_fallback;
+			}
+		}
+	}
+
+	/**
+	 * Width of the widest line of text.
+	 */
+	float GlyphMetrics::measure(std::string_view text) const
+	{
+		if (m_empty)
+		{
+			return 0.f;
+		}
+
+		float widest = 0.f;
+		float advance_sum = 0.f;
+		size_t glyph_count = 0;
+		for (size_t i = 0; i < text.size();)
+		{
+			unsigned char c = (unsigned char)text[i];
+			if (c == '\n')
+			{
+				widest = std::max(widest, line_width(advance_sum, glyph_count));
+				advance_sum = 0.f;
+				glyph_count = 0;
+				i++;
+				continue;
+			}
+
+			int codepoint = c;
+			int size = 1;
+			if (c >= 0x80)
+			{
+				codepoint = GetCodepointNext(text.data() + i, &size);
+			}
+
+			advance_sum += advance(codepoint);
+			glyph_count++;
+			i += size;
+		}
+
+		return std::max(widest, line_width(advance_sum, glyph_count));
+	}
+} // namespace bacon
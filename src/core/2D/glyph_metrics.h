@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <unordered_map>
+
+#include "raylib.h"
+
+namespace bacon
+{
+	/**
+	 * Glyph advances of one font at one size and spacing, so text
+	 * can be measured glyph by glyph instead of re-running
+	 * MeasureTextEx over whole strings.
+	 *
+	 * An advance here is the glyph's scaled advance plus the spacing
+	 * after it; a line's width is the sum of its advances minus one
+	 * spacing, which is what MeasureTextEx gives for a single line.
+	 * Raylib fonts carry no kerning pairs, so there is nothing else
+	 * to apply.
+	 *
+	 * Tables are shared and built on first use, and the least
+	 * recently used ones are dropped past _MAX_TABLES, so animating
+	 * a font size can't grow the cache without limit.
+	 * Main thread only.
+	 */
+	class GlyphMetrics
+	{
+	public:
+		static constexpr int _ASCII_COUNT = 128;
+		// Font, size and spacing combinations kept at once
+		static constexpr size_t _MAX_TABLES = 64;
+
+		static const GlyphMetrics& get(const Font& font, float font_size, float spacing);
+		// Drops the tables of a font that is about to be unloaded
+		static void forget(const Font& font);
+
+		GlyphMetrics(const Font& font, float font_size, float spacing);
+
+		float get_spacing() const { return m_spacing; }
+
+		float advance(int codepoint) const
+		{
+			if (codepoint >= 0 && codepoint < _ASCII_COUNT)
+			{
+				return m_ascii[codepoint];
+			}
+
+			auto it = m_advances.find(codepoint);
+			return (it != m_advances.end()) ? it->second : m_fallback;
+		}
+
+		float line_width(float advance_sum, size_t glyph_count) const
+		{
+			return (glyph_count > 0) ? advance_sum - m_spacing : 0.f;
+		}
+
+		// `text` must be backed by a null-terminated string, since
+		// decoding UTF-8 may look ahead past a truncated sequence
+		float measure(std::string_view text) const;
+
+	private:
+		float m_spacing;
+		// Used for codepoints the font has no glyph for
+		float m_fallback = 0.f;
+		float m_ascii[_ASCII_COUNT] = {};
+		std::unordered_map<int, float> m_advances;
+		// Fonts without glyph data measure as empty, like MeasureTextEx
+		bool m_empty;
+	};
+} // namespace bacon
@@ -17,7 +17,9 @@
 
 namespace bacon
 {
-	Object2D* Object2D::create_object_2d(ByteStream& bytes, TypeID type_id)
+	TransformStore2D Object2D::_transforms;
+
+	Object2D* Object2D::create_object_2d(ByteView& bytes, TypeID type_id)
 	{
 		switch (type_id)
 		{
@@ -39,33 +41,46 @@ namespace bacon
 
 		set_name("Object2D");
 
-		m_position = {0.f, 0.f};
-		m_size = {1.f, 1.f};
-		m_rotation = 0.f;
-		m_is_visible = true;
-		m_layer = 0;
+		m_transform = _transforms.create(this);
+
+		m_scene_index = _INVALID_INDEX;
+		m_type_index = _INVALID_INDEX;
 	}
 
 	Object2D::Object2D(const Object2D& obj) : GameObject()
 	{
 		m_type_id = static_type_id;
+		m_transform = _transforms.create(this);
+		m_scene_index = _INVALID_INDEX;
+		m_type_index = _INVALID_INDEX;
 		this->copy(obj);
 	}
 
+	Object2D::~Object2D()
+	{
+		_transforms.destroy(m_transform);
+	}
+
 	void Object2D::copy(const GameObject& obj)
 	{
 		GameObject::copy(obj);
 
 		const Object2D& object = static_cast<const Object2D&>(obj);
 
-		Vector2 delta = Vector2Subtract(object.m_position, m_position);
-		m_position = object.m_position;
-		m_size = object.m_size;
-		m_rotation = object.m_rotation;
-		m_is_visible = object.m_is_visible;
-		m_layer = object.m_layer;
+		TransformHandle src = object.m_transform;
+		TransformHandle dst = m_transform;
+
+		Vector2 delta = Vector2Subtract(object.get_position(), get_position());
+		_transforms.x[dst] = _transforms.x[src];
+		_transforms.y[dst] = _transforms.y[src];
+		_transforms.w[dst] = _transforms.w[src];
+		_transforms.h[dst] = _transforms.h[src];
+		_transforms.rotation[dst] = _transforms.rotation[src];
+		_transforms.visible[dst] = _transforms.visible[src];
+		_transforms.layer[dst] = _transforms.layer[src];
 
 		update_child_positions(delta);
+		update_bounds();
 	}
 
 	void Object2D::clone_children(const GameObject& object, bool add_to_scene)
@@ -99,8 +114,8 @@ namespace bacon
 			add_child(new_child);
 
 			// Set correct position
-			Vector2 delta = Vector2Subtract(child_obj->m_position, object_2d->m_position);
-			Vector2 pos = Vector2Add(this->m_position, delta);
+			Vector2 delta = Vector2Subtract(child_obj->get_position(), object_2d->get_position());
+			Vector2 pos = Vector2Add(this->get_position(), delta);
 			new_child->set_position(pos);
 
 			// Add to scene
@@ -113,27 +128,54 @@ namespace bacon
 		}
 	}
 
+	/**
+	 * Marks both objects as linked so Scene2D's physics
+	 * writeback moves them through set_transform.
+	 */
+	void Object2D::add_child(GameObject* child)
+	{
+		GameObject::add_child(child);
+
+		_transforms.linked[m_transform] = 1;
+
+		Object2D* child_obj = dynamic_cast_to<Object2D>(child);
+		if (child_obj)
+			_transforms.linked[child_obj->m_transform] = 1;
+	}
+
+	void Object2D::remove_child(GameObject* child)
+	{
+		GameObject::remove_child(child);
+
+		_transforms.linked[m_transform] = !m_children.empty() || m_parent != nullptr;
+
+		Object2D* child_obj = dynamic_cast_to<Object2D>(child);
+		if (child_obj)
+			_transforms.linked[child_obj->m_transform] = !child_obj->m_children.empty();
+	}
+
 	void Object2D::draw_outline() const
 	{
-		Vector2 draw_pos = m_position;
-		float draw_rot = m_rotation;
+		Vector2 draw_pos = get_position();
+		float draw_rot = get_rotation();
 		if (m_parent != nullptr)
 		{
 			Object2D* parent_2d = (Object2D*)m_parent;
 
 			draw_pos = rotate_about_point(
 				draw_pos,
-				parent_2d->m_position,
-				parent_2d->m_rotation);
-			draw_rot += parent_2d->m_rotation;
+				parent_2d->get_position(),
+				parent_2d->get_rotation());
+			draw_rot += parent_2d->get_rotation();
 		}
 
+		Vector2 size = get_size();
 		DrawRectangleLinesPro(
 			{
 				draw_pos.x, //- (size.x / 2.f),
 				draw_pos.y, //- (size.y / 2.f),
-				m_size.x,
-				m_size.y,
+				size.x,
+				size.y,
 			},
 			draw_rot,
 			3.f,
@@ -142,29 +184,53 @@ namespace bacon
 
 	bool Object2D::contains_point(Vector2 point)
 	{
-		Vector2 point_relative = Vector2Subtract(point, m_position);
-		Vector2 p = Vector2Rotate(point_relative, -m_rotation * DEG2RAD);
+		Vector2 position;
+		float rotation;
+		get_world_transform(&position, &rotation);
+
+		Vector2 point_relative = Vector2Subtract(point, position);
+		Vector2 p = Vector2Rotate(point_relative, -rotation * DEG2RAD);
+		Vector2 size = get_size();
 		Rectangle rect = {
-			-m_size.x / 2.f,
-			-m_size.y / 2.f,
-			m_size.x,
-			m_size.y,
+			-size.x / 2.f,
+			-size.y / 2.f,
+			size.x,
+			size.y,
 		};
 
 		return CheckCollisionPointRec(p, rect);
 	}
 
+	/**
+	 * World-space axis-aligned bounds of the object.
+	 * Object2D is centered on its position and rotated
+	 * with its parent, matching how it is drawn.
+	 */
+	Rectangle Object2D::calculate_bounds() const
+	{
+		Vector2 position;
+		float rotation;
+		get_world_transform(&position, &rotation);
+
+		Vector2 size = get_size();
+		return get_rotated_bounds(
+			position,
+			size,
+			{size.x * 0.5f, size.y * 0.5f},
+			rotation);
+	}
+
 	void Object2D::update_ui_buffer() const
 	{
 		ui::obj_properties.name = get_name();
 		ui::obj_properties.tag = get_tag();
-		ui::obj_properties.position[0] = m_position.x;
-		ui::obj_properties.position[1] = m_position.y;
-		ui::obj_properties.size[0] = m_size.x;
-		ui::obj_properties.size[1] = m_size.y;
-		ui::obj_properties.rotation = m_rotation;
-		ui::obj_properties.is_visible = m_is_visible;
-		ui::obj_properties.layer = m_layer;
+		ui::obj_properties.position[0] = get_position().x;
+		ui::obj_properties.position[1] = get_position().y;
+		ui::obj_properties.size[0] = get_size().x;
+		ui::obj_properties.size[1] = get_size().y;
+		ui::obj_properties.rotation = get_rotation();
+		ui::obj_properties.is_visible = get_visible();
+		ui::obj_properties.layer = get_layer();
 	}
 
 	void Object2D::update_from_ui_buffer()
@@ -180,11 +246,11 @@ namespace bacon
 		if (get_in_scene())
 		{
 			GameState::state_2d->renderer->remove_from_layer(this);
-			GameState::state_2d->renderer->add_to_layer(this, m_layer);
+			GameState::state_2d->renderer->add_to_layer(this, get_layer());
 		}
 		else
 		{
-			GameState::state_2d->renderer->add_to_layer(this, m_layer);
+			GameState::state_2d->renderer->add_to_layer(this, get_layer());
 		}
 	}
 
@@ -199,7 +265,10 @@ namespace bacon
 			ui::properties_changes_made = true;
 		}
 		// ImGui::SameLine();
-		ImGui::HelpMarker("ID: " + this->get_uuid().as_string());
+		// Rebuilt every frame, so it lives in the frame arena
+		std::pmr::string id("ID: ", globals::frame_memory());
+		id += get_uuid().as_string(globals::frame_memory());
+		ImGui::HelpMarker(id);
 
 		// Tag
 		ImGui::ItemLabel("Tag", ItemLabelFlag::Left);
@@ -263,71 +332,95 @@ namespace bacon
 	{
 		GameObject::save_to_json(data);
 
-		data["position"] = {m_position.x, m_position.y};
-		data["size"] = {m_size.x, m_size.y};
-		data["rotation"] = m_rotation;
-		data["is_visible"] = m_is_visible;
-		data["layer"] = m_layer;
+		Vector2 position = get_position();
+		Vector2 size = get_size();
+		data["position"] = {position.x, position.y};
+		data["size"] = {size.x, size.y};
+		data["rotation"] = get_rotation();
+		data["is_visible"] = get_visible();
+		data["layer"] = get_layer();
 	}
 
 	void Object2D::load_from_json(const nlohmann::json& data)
 	{
 		GameObject::load_from_json(data);
 
-		m_position = json_read_vector2(data, "position");
-		m_size = json_read_vector2(data, "size");
-		m_rotation = json_read_float(data, "rotation");
-		m_is_visible = json_read_bool(data, "is_visible");
-		m_layer = json_read_size_t(data, "layer");
+		Vector2 position = json_read_vector2(data, "position");
+		Vector2 size = json_read_vector2(data, "size");
+		_transforms.x[m_transform] = position.x;
+		_transforms.y[m_transform] = position.y;
+		_transforms.w[m_transform] = size.x;
+		_transforms.h[m_transform] = size.y;
+		_transforms.rotation[m_transform] = json_read_float(data, "rotation");
+		_transforms.visible[m_transform] = json_read_bool(data, "is_visible");
+		_transforms.layer[m_transform] = (uint32_t)json_read_size_t(data, "layer");
 	}
 
-	ByteStream Object2D::serialize() const
+	void Object2D::serialize_to(ByteStream& bytes) const
 	{
-		ByteStream stream;
-
-		ByteStream base_data = GameObject::serialize();
-		stream << base_data.raw();
-
-		stream << m_position.x << m_position.y;
-		stream << m_size.x << m_size.y;
-		stream << m_rotation;
-		stream << m_is_visible;
-		stream << m_layer;
+		GameObject::serialize_to(bytes);
 
-		return stream;
+		bytes << _transforms.x[m_transform] << _transforms.y[m_transform];
+		bytes << _transforms.w[m_transform] << _transforms.h[m_transform];
+		bytes << _transforms.rotation[m_transform];
+		bytes << get_visible();
+		bytes << (uint64_t)get_layer();
 	}
 
-	void Object2D::deserialize(ByteStream& bytes)
+	void Object2D::deserialize(ByteView& bytes)
 	{
 		GameObject::deserialize(bytes);
 
-		bytes >> m_position.x >> m_position.y;
-		bytes >> m_size.x >> m_size.y;
-		bytes >> m_rotation;
-		bytes >> m_is_visible;
-		bytes >> m_layer;
+		bool is_visible;
+		uint64_t layer;
+		bytes >> _transforms.x[m_transform] >> _transforms.y[m_transform];
+		bytes >> _transforms.w[m_transform] >> _transforms.h[m_transform];
+		bytes >> _transforms.rotation[m_transform];
+		bytes >> is_visible;
+		bytes >> layer;
+		_transforms.visible[m_transform] = is_visible;
+		_transforms.layer[m_transform] = (uint32_t)layer;
 	}
 
 	void Object2D::set_position(Vector2 position)
 	{
-		Vector2 delta = Vector2Subtract(position, m_position);
-		m_position = position;
+		Vector2 delta = Vector2Subtract(position, get_position());
+		_transforms.x[m_transform] = position.x;
+		_transforms.y[m_transform] = position.y;
 		update_child_positions(delta);
+		update_bounds();
 	}
 
 	void Object2D::set_size(Vector2 size)
 	{
-		m_size = size;
+		_transforms.w[m_transform] = size.x;
+		_transforms.h[m_transform] = size.y;
+		update_bounds();
 	}
 
 	void Object2D::set_rotation(float rotation)
 	{
-		m_rotation = rotation;
+		_transforms.rotation[m_transform] = rotation;
+		update_bounds();
+	}
+
+	/**
+	 * Sets position and rotation together so bounds and the
+	 * spatial index are only refreshed once.
+	 */
+	void Object2D::set_transform(Vector2 position, float rotation)
+	{
+		Vector2 delta = Vector2Subtract(position, get_position());
+		_transforms.x[m_transform] = position.x;
+		_transforms.y[m_transform] = position.y;
+		_transforms.rotation[m_transform] = rotation;
+		update_child_positions(delta);
+		update_bounds();
 	}
 
 	void Object2D::set_visibility(bool visibility)
 	{
-		m_is_visible = visibility;
+		_transforms.visible[m_transform] = visibility;
 
 		for (GameObject* child : m_children)
 		{
@@ -341,7 +434,12 @@ namespace bacon
 
 	void Object2D::set_layer(size_t layer)
 	{
-		m_layer = layer;
+		_transforms.layer[m_transform] = (uint32_t)layer;
+		if (GameState::state_2d->renderer == nullptr)
+		{
+			return;
+		}
+
 		if (get_in_scene())
 		{
 			GameState::state_2d->renderer->remove_from_layer(this);
@@ -359,7 +457,51 @@ namespace bacon
 		{
 			Object2D* child_obj = (Object2D*)child;
 
-			child_obj->m_position = Vector2Add(child_obj->m_position, delta);
+			TransformHandle handle = child_obj->m_transform;
+			_transforms.x[handle] += delta.x;
+			_transforms.y[handle] += delta.y;
+		}
+	}
+
+	/**
+	 * Recomputes the world bounds of this object and its children
+	 * and refreshes their entries in the scene's spatial index.
+	 */
+	void Object2D::update_bounds()
+	{
+		_transforms.bounds[m_transform] = calculate_bounds();
+
+		if (_transforms.proxy[m_transform] != TransformStore2D::_NULL_PROXY &&
+			GameState::state_2d != nullptr && GameState::state_2d->scene != nullptr)
+		{
+			GameState::state_2d->scene->update_spatial_index(this);
+		}
+
+		// Child bounds depend on this object's transform
+		for (GameObject* child : m_children)
+		{
+			Object2D* child_obj = dynamic_cast_to<Object2D>(child);
+			if (!child_obj)
+				continue;
+
+			child_obj->update_bounds();
+		}
+	}
+
+	/**
+	 * Position and rotation the object is drawn with,
+	 * i.e. rotated about its parent.
+	 */
+	void Object2D::get_world_transform(Vector2* position, float* rotation) const
+	{
+		*position = get_position();
+		*rotation = get_rotation();
+
+		Object2D* parent = dynamic_cast_to<Object2D>(m_parent);
+		if (parent != nullptr)
+		{
+			*position = rotate_about_point(*position, parent->get_position(), parent->get_rotation());
+			*rotation += parent->get_rotation();
 		}
 	}
 } // namespace bacon
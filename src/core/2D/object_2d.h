@@ -8,6 +8,7 @@
 
 #include "core/uuid.h"
 #include "core/game_object.h"
+#include "core/2D/transform_store_2d.h"
 #include "lib/byte_stream.h"
 
 namespace bacon
@@ -16,8 +17,15 @@ namespace bacon
 	{
 	public:
 		friend class Renderer;
+		friend class Scene2D;
 
-		static Object2D* create_object_2d(ByteStream& bytes, TypeID type_id);
+		// Sentinel for an object that has no slot in the scene lists.
+		static constexpr size_t _INVALID_INDEX = SIZE_MAX;
+
+		// Transform data of every Object2D, see TransformStore2D
+		static TransformStore2D _transforms;
+
+		static Object2D* create_object_2d(ByteView& bytes, TypeID type_id);
 		static bool classof(const GameObject* object)
 		{
 			return object->get_type_id() >= TypeID::OBJECT_2D_START &&
@@ -30,14 +38,17 @@ namespace bacon
 		Object2D& operator=(const Object2D& obj) = delete;
 		Object2D(Object2D&& obj) = delete;
 		Object2D& operator=(Object2D&& obj) = delete;
-		virtual ~Object2D() = default;
+		virtual ~Object2D();
 
 		virtual void copy(const GameObject& object) override;
 
 		void clone_children(const GameObject& object, bool add_to_scene) override;
+		void add_child(GameObject* child) override;
+		void remove_child(GameObject* child) override;
 
 		virtual void draw_outline() const;
 		virtual bool contains_point(Vector2 point);
+		virtual Rectangle calculate_bounds() const;
 
 		virtual void update_ui_buffer() const override;
 		virtual void update_from_ui_buffer() override;
@@ -46,28 +57,36 @@ namespace bacon
 		virtual void draw_properties_editor() override;
 		virtual void save_to_json(nlohmann::json& data) const override;
 		virtual void load_from_json(const nlohmann::json& data) override;
-		virtual ByteStream serialize() const override;
+		virtual void serialize_to(ByteStream& bytes) const override;
 
 		void set_position(Vector2 position);
 		void set_size(Vector2 size);
 		void set_rotation(float rotation);
+		void set_transform(Vector2 position, float rotation);
 		void set_visibility(bool visibility);
 		void set_layer(size_t layer);
 		void update_child_positions(Vector2 delta);
-		Vector2 get_position() const 	{ return m_position; }
-		Vector2 get_size() const 		{ return m_size; }
-		float get_rotation() const 		{ return m_rotation; }
-		bool get_visible() const 		{ return m_is_visible; }
-		size_t get_layer() const 		{ return m_layer; }
+		void update_bounds();
+		void get_world_transform(Vector2* position, float* rotation) const;
+		Vector2 get_position() const 	{ return {_transforms.x[m_transform], _transforms.y[m_transform]}; }
+		Vector2 get_size() const 		{ return {_transforms.w[m_transform], _transforms.h[m_transform]}; }
+		float get_rotation() const 		{ return _transforms.rotation[m_transform]; }
+		bool get_visible() const 		{ return _transforms.visible[m_transform] != 0; }
+		size_t get_layer() const 		{ return _transforms.layer[m_transform]; }
+		Rectangle get_bounds() const 	{ return _transforms.bounds[m_transform]; }
+		TransformHandle get_transform_handle() const { return m_transform; }
 
 	protected:
-		virtual void deserialize(ByteStream& bytes) override;
+		virtual void deserialize(ByteView& bytes) override;
 
 	private:
-		Vector2 m_position;
-		Vector2 m_size;
-		float m_rotation;
-		bool m_is_visible;
-		size_t m_layer;
+		// Slot in _transforms holding position, size, rotation,
+		// visibility, layer, bounds and the spatial index proxy.
+		TransformHandle m_transform;
+
+		// Dense indices into Scene2D's object list and typed list.
+		// Maintained by Scene2D for O(1) swap-and-pop removal.
+		size_t m_scene_index;
+		size_t m_type_index;
 	};
 } // namespace bacon
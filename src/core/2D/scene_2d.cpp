@@ -1,7 +1,8 @@
 #include "scene_2d.h"
 
+#include <algorithm>
+#include <cmath>
 #include <memory>
-#include <stdexcept>
 
 #include "box2d/box2d.h"
 #include "box2d/id.h"
@@ -10,18 +11,47 @@
 #include "core/2D/entity_2d.h"
 #include "core/2D/object_2d.h"
 #include "core/game_state.h"
+#include "core/globals.h"
+#include "core/job_system.h"
+#include "core/profiler.h"
 #include "core/util.h"
 #include "raylib.h"
 
 namespace bacon
 {
+	// Margin added around bounds stored in the spatial index so
+	// small movements don't restructure the tree every frame.
+	static constexpr float _SPATIAL_INDEX_MARGIN = 8.f;
+
+	static b2AABB rect_to_aabb(Rectangle rect)
+	{
+		return (b2AABB){
+			{rect.x, rect.y},
+			{rect.x + rect.width, rect.y + rect.height},
+		};
+	}
+
+	static Rectangle expand_rect(Rectangle rect, float margin)
+	{
+		return {
+			rect.x - margin,
+			rect.y - margin,
+			rect.width + margin * 2.f,
+			rect.height + margin * 2.f,
+		};
+	}
+
 	Scene2D::Scene2D()
 	{
 		m_camera = nullptr;
+		m_spatial_index = b2DynamicTree_Create();
 
 		m_length_units_per_meter = 128.0f;
 		m_gravity = 9.8f * m_length_units_per_meter;
 
+		m_accumulator = 0.f;
+		m_step_count = 0;
+
 		this->create_physics_world();
 
 		lua_state = std::make_unique<sol::state>();
@@ -52,55 +82,44 @@ namespace bacon
 		return m_camera_objects;
 	}
 
+	/**
+	 * Memory for objects that live as long as the scene, to be
+	 * used with ObjectMemoryScope while a level loads.
+	 */
+	std::pmr::memory_resource* Scene2D::get_object_memory()
+	{
+		if (!use_arena)
+		{
+			return std::pmr::get_default_resource();
+		}
+
+		return &m_arena;
+	}
+
 	void Scene2D::add_entity(Entity2D* entity)
 	{
-		m_objects.push_back(entity);
-		m_object_lookup.emplace(entity->get_uuid().as_string(), entity);
-		m_entities.push_back(entity);
+		insert_object(entity);
+		insert_typed(m_entities, entity);
 	}
 
 	void Scene2D::remove_entity(Entity2D* entity)
 	{
 		if (!entity->get_in_scene()) return;
 
-		bool found = false;
-
-		// Remove from objects list
-		for (auto it = m_objects.begin(); it != m_objects.end(); it++)
-		{
-			Object2D* object = *it;
-			if (object->get_uuid() == entity->get_uuid())
-			{
-				m_objects.erase(it);
-				found = true;
-				break;
-			}
-		}
-		if (!found)
+		if (!erase_object(entity))
 		{
 			return;
 		}
 
-		found = false;
-
-		// Remove from entity list
-		for (auto it = m_entities.begin(); it != m_entities.end(); it++)
-		{
-			Entity2D* ent = *it;
-			if (ent->get_uuid() == entity->get_uuid())
-			{
-				m_entities.erase(it);
-				found = true;
-				break;
-			}
-		}
-		if (!found)
+		if (!erase_typed(m_entities, entity))
 		{
 			return;
 		}
 
 		// Remove from lookup
-		m_object_lookup.erase(entity->get_uuid().as_string());
+		m_object_lookup.erase(entity->get_uuid());
+
+		forget_moved(entity);
 
 		// Destroy physics body
 		if (b2Body_IsValid(entity->get_body_id()))
@@ -117,60 +136,32 @@ namespace bacon
 
 	void Scene2D::add_text_object(TextObject* text)
 	{
-		m_objects.push_back(text);
-		m_object_lookup.emplace(text->get_uuid().as_string(), text);
-		m_text_objects.push_back(text);
+		insert_object(text);
+		insert_typed(m_text_objects, text);
 	}
 
 	void Scene2D::remove_text_object(TextObject* text)
 	{
 		if (!text->get_in_scene()) return;
 
-		bool found = false;
-
-		// Remove from objects list
-		for (auto it = m_objects.begin(); it != m_objects.end(); it++)
-		{
-			Object2D* object = *it;
-			if (object->get_uuid() == text->get_uuid())
-			{
-				m_objects.erase(it);
-				found = true;
-				break;
-			}
-		}
-		if (!found)
+		if (!erase_object(text))
 		{
 			return;
 		}
 
-		found = false;
-
-		// Remove from text objects list
-		for (auto it = m_text_objects.begin(); it != m_text_objects.end(); it++)
-		{
-			TextObject* txt = *it;
-			if (txt->get_uuid() == text->get_uuid())
-			{
-				m_text_objects.erase(it);
-				found = true;
-				break;
-			}
-		}
-		if (!found)
+		if (!erase_typed(m_text_objects, text))
 		{
 			return;
 		}
 
 		// Remove from object lookup
-		m_object_lookup.erase(text->get_uuid().as_string());
+		m_object_lookup.erase(text->get_uuid());
 	}
 
 	void Scene2D::add_camera(CameraObject* camera)
 	{
-		m_objects.push_back(camera);
-		m_object_lookup.emplace(camera->get_uuid().as_string(), camera);
-		m_camera_objects.push_back(camera);
+		insert_object(camera);
+		insert_typed(m_camera_objects, camera);
 	}
 
 	void Scene2D::remove_camera(CameraObject* camera)
@@ -182,65 +173,183 @@ namespace bacon
 			m_camera = nullptr;
 		}
 
-		bool found = false;
-
-		// Remove from objects list
-		for (auto it = m_objects.begin(); it != m_objects.end(); it++)
+		if (!erase_object(camera))
 		{
-			Object2D* object = *it;
-			if (object->get_uuid() == camera->get_uuid())
-			{
-				m_objects.erase(it);
-				found = true;
-				break;
-			}
+			return;
 		}
-		if (!found)
+
+		if (!erase_typed(m_camera_objects, camera))
 		{
 			return;
 		}
 
-		found = false;
+		// Remove from object lookup
+		m_object_lookup.erase(camera->get_uuid());
+	}
+
+	void Scene2D::insert_object(Object2D* object)
+	{
+		object->m_scene_index = m_objects.size();
+		m_objects.push_back(object);
+		m_object_lookup.insert(object->get_uuid(), object);
+
+		TransformStore2D& transforms = Object2D::_transforms;
+		TransformHandle handle = object->m_transform;
+
+		transforms.bounds[handle] = object->calculate_bounds();
+		transforms.index_bounds[handle] = expand_rect(transforms.bounds[handle], _SPATIAL_INDEX_MARGIN);
+		transforms.proxy[handle] = b2DynamicTree_CreateProxy(
+			&m_spatial_index,
+			rect_to_aabb(transforms.index_bounds[handle]),
+			B2_DEFAULT_CATEGORY_BITS,
+			(uint64_t)(uintptr_t)object);
+	}
 
-		// Remove from camera objects list
-		for (auto it = m_camera_objects.begin(); it != m_camera_objects.end();
-			 it++)
+	/**
+	 * Removes an object from the object list in O(1).
+	 * The last object is swapped into the freed slot, so
+	 * the order of get_objects() is not preserved.
+	 */
+	bool Scene2D::erase_object(Object2D* object)
+	{
+		size_t index = object->m_scene_index;
+		if (index >= m_objects.size() || m_objects[index] != object)
 		{
-			CameraObject* cam = *it;
-			if (cam->get_uuid() == camera->get_uuid())
-			{
-				m_camera_objects.erase(it);
-				found = true;
-				break;
-			}
+			return false;
+		}
+
+		Object2D* last = m_objects.back();
+		m_objects[index] = last;
+		last->m_scene_index = index;
+		m_objects.pop_back();
+
+		object->m_scene_index = Object2D::_INVALID_INDEX;
+
+		int32_t& proxy = Object2D::_transforms.proxy[object->m_transform];
+		if (proxy != TransformStore2D::_NULL_PROXY)
+		{
+			b2DynamicTree_DestroyProxy(&m_spatial_index, proxy);
+			proxy = TransformStore2D::_NULL_PROXY;
+		}
+
+		return true;
+	}
+
+	/**
+	 * Moves the object's proxy if its bounds have left the
+	 * enlarged bounds stored in the tree.
+	 */
+	void Scene2D::update_spatial_index(Object2D* object)
+	{
+		update_spatial_index(object->m_transform);
+	}
+
+	void Scene2D::update_spatial_index(TransformHandle handle)
+	{
+		TransformStore2D& transforms = Object2D::_transforms;
+		if (transforms.proxy[handle] == TransformStore2D::_NULL_PROXY)
+		{
+			return;
 		}
-		if (!found)
+
+		const Rectangle& bounds = transforms.bounds[handle];
+		if (rect_contains_rect(transforms.index_bounds[handle], bounds))
 		{
 			return;
 		}
 
-		// Remove from object lookup
-		m_object_lookup.erase(camera->get_uuid().as_string());
+		transforms.index_bounds[handle] = expand_rect(bounds, _SPATIAL_INDEX_MARGIN);
+		b2DynamicTree_MoveProxy(
+			&m_spatial_index,
+			transforms.proxy[handle],
+			rect_to_aabb(transforms.index_bounds[handle]));
 	}
 
-	Object2D* Scene2D::find_object_by_uuid(std::string uuid) const
+	typedef struct
 	{
-		try
+		Vector2 point;
+		Object2D* result;
+	} PickQuery;
+
+	bool Scene2D::pick_query_callback(int proxy_id, uint64_t user_data, void* context)
+	{
+		PickQuery* query = (PickQuery*)context;
+		Object2D* object = (Object2D*)(uintptr_t)user_data;
+
+		// Keep the earliest object in scene order so picking
+		// doesn't depend on tree layout.
+		if (query->result != nullptr && query->result->m_scene_index < object->m_scene_index)
 		{
-			Object2D* object = m_object_lookup.at(uuid);
-			return object;
+			return true;
 		}
-		catch (const std::out_of_range&)
+
+		if (object->contains_point(query->point))
 		{
-			return nullptr;
+			query->result = object;
 		}
+
+		return true;
+	}
+
+	/**
+	 * Returns the object under a world-space point,
+	 * or nullptr if there is none.
+	 */
+	Object2D* Scene2D::pick_object(Vector2 point) const
+	{
+		PickQuery query = {point, nullptr};
+		b2AABB aabb = {{point.x, point.y}, {point.x, point.y}};
+
+		b2DynamicTree_Query(&m_spatial_index, aabb, B2_DEFAULT_MASK_BITS, pick_query_callback, &query);
+
+		return query.result;
+	}
+
+	typedef struct
+	{
+		Rectangle rect;
+		std::vector<Object2D*>* results;
+	} RectQuery;
+
+	bool Scene2D::rect_query_callback(int proxy_id, uint64_t user_data, void* context)
+	{
+		RectQuery* query = (RectQuery*)context;
+		Object2D* object = (Object2D*)(uintptr_t)user_data;
+
+		// The tree stores enlarged bounds, so test the exact ones.
+		if (CheckCollisionRecs(object->get_bounds(), query->rect))
+		{
+			query->results->push_back(object);
+		}
+
+		return true;
+	}
+
+	/**
+	 * Appends every object whose bounds overlap a
+	 * world-space rectangle to results.
+	 */
+	void Scene2D::query_objects(Rectangle rect, std::vector<Object2D*>& results) const
+	{
+		RectQuery query = {rect, &results};
+
+		b2DynamicTree_Query(&m_spatial_index, rect_to_aabb(rect), B2_DEFAULT_MASK_BITS, rect_query_callback, &query);
+	}
+
+	Object2D* Scene2D::find_object_by_uuid(const std::string& uuid) const
+	{
+		return find_object_by_uuid(UUID(uuid));
 	}
 
 	Object2D* Scene2D::find_object_by_uuid(UUID uuid) const
 	{
-		std::string uuid_string = uuid.as_string();
+		Object2D* const* object = m_object_lookup.find(uuid);
+		if (object == nullptr)
+		{
+			return nullptr;
+		}
 
-		return find_object_by_uuid(uuid_string);
+		return *object;
 	}
 
 	void Scene2D::set_active_camera(CameraObject* camera)
@@ -286,9 +395,22 @@ namespace bacon
 		b2WorldDef world_def = b2DefaultWorldDef();
 
 		world_def.gravity = (b2Vec2){0.0f, this->m_gravity};
-		world_def.enableSleep = false;
+		world_def.enableSleep = true;
+
+		if (globals::job_system != nullptr)
+		{
+			world_def.workerCount = (int)globals::job_system->get_worker_count();
+			world_def.enqueueTask = JobSystem::enqueue_box2d_task;
+			world_def.finishTask = JobSystem::finish_box2d_task;
+			world_def.userTaskContext = globals::job_system;
+		}
 
 		this->m_world = b2CreateWorld(&world_def);
+
+		m_accumulator = 0.f;
+		m_body_poses.clear();
+		m_moved.clear();
+		m_previously_moved.clear();
 	}
 
 	float Scene2D::get_gravity() const
@@ -317,21 +439,175 @@ namespace bacon
 
 	void Scene2D::simulation_step()
 	{
-		float delta_time = GetFrameTime();
+		simulation_step(GetFrameTime());
+	}
+
+	/**
+	 * Advances physics by delta_time seconds.
+	 * In fixed timestep mode the world is stepped in whole
+	 * 1 / physics_rate increments and the remainder is carried
+	 * to the next frame; drawn transforms are interpolated
+	 * between the last two steps.
+	 */
+	void Scene2D::simulation_step(float delta_time)
+	{
+		PROFILE_SCOPE("Scene2D::simulation_step");
+
+		if (!fixed_timestep || physics_rate <= 0.f)
+		{
+			step_world(delta_time);
+			interpolate_transforms(1.f);
+			return;
+		}
+
+		const float fixed_delta = 1.f / physics_rate;
+
+		m_accumulator += delta_time;
+
+		int steps = 0;
+		while (m_accumulator >= fixed_delta && steps < max_substeps)
+		{
+			step_world(fixed_delta);
+			m_accumulator -= fixed_delta;
+			steps++;
+		}
+
+		// Too far behind, drop the backlog instead of trying to
+		// catch up (which would only make the next frame longer).
+		if (m_accumulator >= fixed_delta)
+		{
+			m_accumulator = fmodf(m_accumulator, fixed_delta);
+		}
+
+		interpolate_transforms(m_accumulator / fixed_delta);
+	}
+
+	void Scene2D::step_world(float delta_time)
+	{
+		PROFILE_SCOPE("Scene2D::step_world");
+
 		b2World_Step(this->m_world, delta_time, this->physics_steps);
+		m_step_count++;
 
-		// Perform entity updates
-		for (Entity2D* entity : this->m_entities)
+		const TransformStore2D& transforms = Object2D::_transforms;
+		transforms.assert_owner();
+		if (m_body_poses.size() < transforms.capacity())
 		{
-			if (entity->get_body_type() == BodyType::NONE)
+			m_body_poses.resize(transforms.capacity(), {b2Transform_identity, b2Transform_identity, 0});
+		}
+
+		m_previously_moved.swap(m_moved);
+		m_moved.clear();
+
+		// Only bodies that moved this step report an event, so static
+		// and sleeping bodies cost nothing here.
+		b2BodyEvents events = b2World_GetBodyEvents(this->m_world);
+		for (int i = 0; i < events.moveCount; i++)
+		{
+			const b2BodyMoveEvent& event = events.moveEvents[i];
+			Entity2D* entity = (Entity2D*)event.userData;
+			if (entity == nullptr)
 				continue;
 
-			b2Vec2 pos = b2Body_GetPosition(entity->get_body_id());
-			b2Rot rotation = b2Body_GetRotation(entity->get_body_id());
-			float radians = b2Rot_GetAngle(rotation);
+			TransformHandle handle = entity->get_transform_handle();
+			BodyPose& pose = m_body_poses[handle];
+
+			// A body that was at rest starts from where it is drawn
+			bool was_moving = pose.moved_step != 0 && pose.moved_step + 1 == m_step_count;
+			if (was_moving)
+			{
+				pose.previous = pose.current;
+			}
+			else
+			{
+				pose.previous.p = {transforms.x[handle], transforms.y[handle]};
+				pose.previous.q = b2MakeRot(transforms.rotation[handle] * DEG2RAD);
+			}
+
+			pose.current = event.transform;
+			pose.moved_step = m_step_count;
+			m_moved.push_back(handle);
+		}
+
+		// Event order is arbitrary; sort so the writeback is a
+		// forward walk over the transform arrays.
+		std::sort(m_moved.begin(), m_moved.end());
 
-			entity->set_position({pos.x, pos.y});
-			entity->set_rotation(radians * RAD2DEG);
+		// Bodies that stopped this step settle on their final transform
+		for (TransformHandle handle : m_previously_moved)
+		{
+			BodyPose& pose = m_body_poses[handle];
+			if (pose.moved_step == m_step_count)
+				continue;
+
+			pose.previous = pose.current;
+			write_body_transform(handle, pose.current);
+		}
+		m_previously_moved.clear();
+	}
+
+	/**
+	 * Writes transforms blended between the previous and latest
+	 * physics step (alpha 0 to 1) for every body that is moving.
+	 */
+	void Scene2D::interpolate_transforms(float alpha)
+	{
+		PROFILE_SCOPE("Scene2D::interpolate_transforms");
+
+		for (TransformHandle handle : m_moved)
+		{
+			const BodyPose& pose = m_body_poses[handle];
+
+			b2Transform transform;
+			transform.p = b2Lerp(pose.previous.p, pose.current.p, alpha);
+			transform.q = b2NLerp(pose.previous.q, pose.current.q, alpha);
+
+			write_body_transform(handle, transform);
+		}
+	}
+
+	/**
+	 * Writes a body transform straight into the transform arrays
+	 * and refreshes its bounds and spatial index entry.
+	 * Objects with a parent or children take the slower
+	 * Object2D::set_transform path, which also moves the hierarchy.
+	 */
+	void Scene2D::write_body_transform(TransformHandle handle, const b2Transform& transform)
+	{
+		TransformStore2D& transforms = Object2D::_transforms;
+		float rotation = b2Rot_GetAngle(transform.q) * RAD2DEG;
+
+		if (transforms.linked[handle])
+		{
+			transforms.owner[handle]->set_transform({transform.p.x, transform.p.y}, rotation);
+			return;
+		}
+
+		transforms.x[handle] = transform.p.x;
+		transforms.y[handle] = transform.p.y;
+		transforms.rotation[handle] = rotation;
+
+		// Same as Object2D::calculate_bounds for an object without a parent
+		Vector2 size = {transforms.w[handle], transforms.h[handle]};
+		transforms.bounds[handle] = get_rotated_bounds(
+			{transform.p.x, transform.p.y},
+			size,
+			{size.x * 0.5f, size.y * 0.5f},
+			rotation);
+
+		update_spatial_index(handle);
+	}
+
+	void Scene2D::forget_moved(Entity2D* entity)
+	{
+		TransformHandle handle = entity->get_transform_handle();
+		std::erase(m_moved, handle);
+		std::erase(m_previously_moved, handle);
+
+		// The slot may be reused by a new body
+		if (handle < m_body_poses.size())
+		{
+			m_body_poses[handle].moved_step = 0;
 		}
 	}
 
@@ -370,6 +646,11 @@ namespace bacon
 		m_entities.clear();
 		m_camera_objects.clear();
 		m_text_objects.clear();
+		m_object_lookup.clear();
+		m_arena.release();
+
+		b2DynamicTree_Destroy(&m_spatial_index);
+		m_spatial_index = b2DynamicTree_Create();
 
 		m_camera = nullptr;
 
@@ -388,6 +669,7 @@ namespace bacon
 			}
 		}
 		b2DestroyWorld(m_world);
+		b2DynamicTree_Destroy(&m_spatial_index);
 
 		for (GameObject* object : m_objects)
 		{
@@ -398,5 +680,7 @@ namespace bacon
 		m_entities.clear();
 		m_camera_objects.clear();
 		m_text_objects.clear();
+		m_object_lookup.clear();
+		m_arena.release();
 	}
 } // namespace bacon
@@ -1,11 +1,17 @@
 #pragma once
 
+#include <memory_resource>
+
+#include "box2d/collision.h"
+#include "box2d/math_functions.h"
 #include "sol/sol.hpp"
 
 #include "core/2D/object_2d.h"
 #include "core/2D/camera_object.h"
 #include "core/2D/entity_2d.h"
 #include "core/2D/text_object.h"
+#include "core/uuid.h"
+#include "lib/flat_hash_map.h"
 
 namespace bacon
 {
@@ -13,6 +19,15 @@ namespace bacon
 	{
 	public:
 		int physics_steps = 4;
+		// Step physics at a fixed rate and interpolate the drawn
+		// transforms between the last two steps.
+		bool fixed_timestep = true;
+		float physics_rate = 60.f;
+		// Steps allowed per frame before the backlog is dropped
+		int max_substeps = 8;
+		// Keep the members of loaded objects in the scene arena,
+		// so unloading frees them with a single release
+		bool use_arena = true;
 		std::unique_ptr<sol::state> lua_state;
 
 		Scene2D();
@@ -34,9 +49,16 @@ namespace bacon
 		void add_camera(CameraObject* camera);
 		void remove_camera(CameraObject* camera);
 
-		Object2D* find_object_by_uuid(std::string uuid) const;
+		Object2D* find_object_by_uuid(const std::string& uuid) const;
 		Object2D* find_object_by_uuid(UUID uuid) const;
 
+		std::pmr::memory_resource* get_object_memory();
+
+		void update_spatial_index(Object2D* object);
+		void update_spatial_index(TransformHandle handle);
+		Object2D* pick_object(Vector2 point) const;
+		void query_objects(Rectangle rect, std::vector<Object2D*>& results) const;
+
 		void set_active_camera(CameraObject* camera);
 		CameraObject* get_active_camera() const;
 
@@ -49,6 +71,7 @@ namespace bacon
 		void set_unit_length(float pixels_per_meter);
 
 		void simulation_step();
+		void simulation_step(float delta_time);
 		void draw_entities(Camera2D* camera = nullptr) const;
 
 		void reset();
@@ -59,12 +82,84 @@ namespace bacon
 		std::vector<Entity2D*> m_entities;
 		std::vector<TextObject*> m_text_objects;
 		std::vector<CameraObject*> m_camera_objects;
-		std::unordered_map<std::string, Object2D*> m_object_lookup;
+		FlatHashMap<UUID, Object2D*, UUIDHash> m_object_lookup;
+
+		// Backs the strings, child lists and script data of objects
+		// created under ObjectMemoryScope(get_object_memory()).
+		// Freeing into it does nothing; it is released as a whole
+		// once reset() or cleanup() has deleted every object.
+		std::pmr::monotonic_buffer_resource m_arena;
 
 		CameraObject* m_camera;
 
+		// Dynamic AABB tree over object bounds, used for
+		// picking and view queries.
+		b2DynamicTree m_spatial_index;
+
 		b2WorldId m_world;
 		float m_length_units_per_meter;
 		float m_gravity;
+
+		// Unsimulated time carried over between frames
+		float m_accumulator;
+		uint64_t m_step_count;
+
+		// Body transforms after the previous and latest physics
+		// steps, used for render interpolation.
+		typedef struct
+		{
+			b2Transform previous;
+			b2Transform current;
+			// m_step_count of the last move event for this body
+			uint64_t moved_step;
+		} BodyPose;
+
+		// Indexed by TransformHandle, parallel to Object2D::_transforms
+		std::vector<BodyPose> m_body_poses;
+		// Handles of bodies that moved in the latest step and the
+		// one before, sorted so the writeback walks the arrays forward
+		std::vector<TransformHandle> m_moved;
+		std::vector<TransformHandle> m_previously_moved;
+
+		void step_world(float delta_time);
+		void interpolate_transforms(float alpha);
+		void write_body_transform(TransformHandle handle, const b2Transform& transform);
+		void forget_moved(Entity2D* entity);
+
+		void insert_object(Object2D* object);
+		bool erase_object(Object2D* object);
+
+		static bool pick_query_callback(int proxy_id, uint64_t user_data, void* context);
+		static bool rect_query_callback(int proxy_id, uint64_t user_data, void* context);
+
+		template <typename T>
+		void insert_typed(std::vector<T*>& list, T* object)
+		{
+			object->m_type_index = list.size();
+			list.push_back(object);
+		}
+
+		/**
+		 * Swap-and-pop removal from a typed list.
+		 * The last element is moved into the freed slot
+		 * and its handle is updated.
+		 */
+		template <typename T>
+		bool erase_typed(std::vector<T*>& list, T* object)
+		{
+			size_t index = object->m_type_index;
+			if (index >= list.size() || list[index] != object)
+			{
+				return false;
+			}
+
+			T* last = list.back();
+			list[index] = last;
+			last->m_type_index = index;
+			list.pop_back();
+
+			object->m_type_index = Object2D::_INVALID_INDEX;
+			return true;
+		}
 	};
 } // namespace bacon
@@ -1,14 +1,15 @@
 #include "text_object.h"
 
 #include <algorithm>
+#include <cctype>
 #include <cstring>
-#include <sstream>
 
 #include "core/2D/object_2d.h"
 #include "imgui.h"
 #include "imgui_stdlib.h"
 #include "raylib.h"
 #include "raymath.h"
+#include "rlgl.h"
 
 #include "core/game_state.h"
 #include "core/globals.h"
@@ -20,7 +21,21 @@
 
 namespace bacon
 {
-	PoolAllocator<TextObject> TextObject::_allocator(globals::allocator_block_size);
+	/**
+	 * MeasureTextEx, except a font without glyphs (the default
+	 * font when no window was ever opened) measures as empty.
+	 */
+	static Vector2 measure_text(const Font& font, const char* text, float font_size, float spacing)
+	{
+		if (font.glyphs == nullptr)
+		{
+			return {0.f, 0.f};
+		}
+
+		return MeasureTextEx(font, text, font_size, spacing);
+	}
+
+	ConcurrentPoolAllocator<TextObject> TextObject::_allocator(globals::allocator_block_size);
 
 	void* TextObject::operator new(size_t size)
 	{
@@ -52,17 +67,20 @@ namespace bacon
 		m_font_size = 12;
 		m_char_spacing = 0;
 		m_color = BLACK;
+		m_text_extent = {0.f, 0.f};
 	}
 
-	TextObject::TextObject(ByteStream& bytes) : Object2D()
+	TextObject::TextObject(ByteView& bytes) : Object2D()
 	{
 		m_type_id = TypeID::TEXT_2D;
+		m_text_extent = {0.f, 0.f};
 		deserialize(bytes);
 	}
 
 	TextObject::TextObject(const TextObject& text_object) : Object2D()
 	{
 		m_type_id = TypeID::TEXT_2D;
+		m_text_extent = {0.f, 0.f};
 		copy(text_object);
 	}
 
@@ -72,11 +90,11 @@ namespace bacon
 
 		const TextObject& text_object = static_cast<const TextObject&>(object);
 
-		this->set_font(text_object.m_font_path);
+		this->set_font(std::string(text_object.m_font_path));
 		this->m_font_size = text_object.m_font_size;
 		this->m_char_spacing = text_object.m_char_spacing;
 		this->m_color = text_object.m_color;
-		set_text(text_object.m_text); // Call last
+		set_text(std::string(text_object.m_text)); // Call last
 	}
 
 	TextObject* TextObject::clone() const
@@ -97,7 +115,10 @@ namespace bacon
 		if (get_in_scene()) return;
 
 		GameState::state_2d->scene->add_text_object(this);
-		GameState::state_2d->renderer->add_to_layer(this, get_layer());
+		if (GameState::state_2d->renderer != nullptr)
+		{
+			GameState::state_2d->renderer->add_to_layer(this, get_layer());
+		}
 		set_in_scene(true);
 
 		add_children_to_scene();
@@ -108,7 +129,10 @@ namespace bacon
 		if (!get_in_scene()) return;
 
 		GameState::state_2d->scene->remove_text_object(this);
-		GameState::state_2d->renderer->remove_from_layer(this);
+		if (GameState::state_2d->renderer != nullptr)
+		{
+			GameState::state_2d->renderer->remove_from_layer(this);
+		}
 		set_in_scene(false);
 
 		remove_children_from_scene();
@@ -131,8 +155,17 @@ namespace bacon
 			return;
 		}
 
-		m_font = GameState::state_2d->assets->load_font(font_path.c_str());
-		if (m_font == nullptr)
+		m_font = nullptr;
+		bool headless = true;
+		if (GameState::state_2d != nullptr && GameState::state_2d->assets != nullptr)
+		{
+			m_font = GameState::state_2d->assets->load_font_async(font_path);
+			headless = GameState::state_2d->assets->is_headless();
+		}
+
+		// Headless runs can't load fonts but keep the path so
+		// the project saves unchanged.
+		if (m_font == nullptr && !headless)
 		{
 			m_font_path = "";
 		}
@@ -152,122 +185,135 @@ namespace bacon
 
 	void TextObject::update_render_text()
 	{
-		float text_width = calculate_text_width(m_text);
-
-		if (text_width > get_size().x)
+		if (get_glyph_metrics().measure(m_text) > get_size().x)
 		{
-			m_render_text = this->get_wrapped_text(m_text);
+			this->wrap_text(m_text, m_render_text);
 		}
 		else
 		{
 			m_render_text = m_text;
 		}
+
+		// Text may overflow its size vertically, so the bounds
+		// use whichever is larger.
+		Font font = (m_font != nullptr) ? *m_font : GetFontDefault();
+		m_text_extent = measure_text(font, m_render_text.c_str(), m_font_size, m_char_spacing);
+		update_bounds();
+
+		m_quads_dirty = true;
 	}
 
-	float TextObject::calculate_text_width(const std::string& text)
+	const GlyphMetrics& TextObject::get_glyph_metrics() const
 	{
-		Vector2 size_vector = {0, 0};
-		if (m_font != nullptr)
-		{
-			size_vector = MeasureTextEx(
-				*m_font,
-				text.data(),
-				m_font_size,
-				m_char_spacing);
-		}
-		else
-		{
-			size_vector = MeasureTextEx(
-				GetFontDefault(),
-				text.data(),
-				m_font_size,
-				m_char_spacing);
-		}
-
-		return size_vector.x;
+		const Font& font = (m_font != nullptr) ? *m_font : GetFontDefault();
+		return GlyphMetrics::get(font, (float)m_font_size, (float)m_char_spacing);
 	}
 
-	std::string TextObject::get_wrapped_text(const std::string& text)
+	/**
+	 * Greedy word wrap to the object's width in a single pass.
+	 * Runs of whitespace collapse to one space, and words wider
+	 * than a line are split between glyphs. `wrapped` is reused,
+	 * so rewrapping doesn't allocate once it has grown.
+	 */
+	void TextObject::wrap_text(std::string_view text, std::pmr::string& wrapped) const
 	{
-		std::stringstream input(text);
-		std::string paragraph = "";
-		std::string final = "";
-		bool first_paragraph = true;
+		const GlyphMetrics& metrics = get_glyph_metrics();
+		const float max_width = get_size().x;
+		const float space_advance = metrics.advance(' ');
+		const char* data = text.data();
+		const size_t length = text.size();
 
-		while (std::getline(input, paragraph))
-		{
-			std::istringstream iss(paragraph);
-			std::string word;
-			std::string line;
-			std::string wrapped_paragraph;
+		wrapped.clear();
+		wrapped.reserve(length + length / 8);
+
+		// Running width of the line being built
+		float line_advance = 0.f;
+		size_t line_glyphs = 0;
 
-			while (iss >> word)
+		size_t i = 0;
+		while (i < length)
+		{
+			unsigned char c = (unsigned char)data[i];
+			if (c == '\n')
 			{
-				std::string current_line;
-				if (line.empty())
-				{
-					current_line = word;
-				}
-				else
+				// A trailing newline adds no empty line
+				if (i + 1 < length)
 				{
-					current_line = line + " " + word;
+					wrapped += '\n';
 				}
+				line_advance = 0.f;
+				line_glyphs = 0;
+				i++;
+				continue;
+			}
 
-				float current_width = calculate_text_width(current_line);
+			if (isspace(c))
+			{
+				i++;
+				continue;
+			}
 
-				if (current_width <= get_size().x)
-				{
-					line = current_line;
-				}
-				else
-				{
-					if (!wrapped_paragraph.empty())
-					{
-						wrapped_paragraph += '\n';
-					}
-
-					if (calculate_text_width(word) > get_size().x)
-					{
-						std::string broken;
-						for (char c : word)
-						{
-							std::string test = broken + c;
-							if (calculate_text_width(test) > get_size().x)
-							{
-								wrapped_paragraph += broken + '\n';
-								broken.clear();
-							}
-							broken += c;
-						}
-						line = broken;
-					}
-					else
-					{
-						wrapped_paragraph += line;
-						line = word;
-					}
-				}
+			// Measure the word
+			const size_t word_start = i;
+			float word_advance = 0.f;
+			size_t word_glyphs = 0;
+			while (i < length && !isspace((unsigned char)data[i]))
+			{
+				int size = 1;
+				int codepoint = GetCodepointNext(data + i, &size);
+				word_advance += metrics.advance(codepoint);
+				word_glyphs++;
+				i += size;
 			}
+			const size_t word_length = i - word_start;
 
-			if (!line.empty())
+			if (line_glyphs > 0)
 			{
-				if (!wrapped_paragraph.empty())
+				float joined = line_advance + space_advance + word_advance;
+				if (metrics.line_width(joined, line_glyphs + 1 + word_glyphs) <= max_width)
 				{
-					wrapped_paragraph += '\n';
+					wrapped += ' ';
+					wrapped.append(data + word_start, word_length);
+					line_advance = joined;
+					line_glyphs += 1 + word_glyphs;
+					continue;
 				}
-				wrapped_paragraph += line;
+
+				wrapped += '\n';
+				line_advance = 0.f;
+				line_glyphs = 0;
 			}
 
-			if (!first_paragraph)
+			if (metrics.line_width(word_advance, word_glyphs) <= max_width)
 			{
-				final += '\n';
+				wrapped.append(data + word_start, word_length);
+				line_advance = word_advance;
+				line_glyphs = word_glyphs;
+				continue;
 			}
 
-			final += wrapped_paragraph;
-			first_paragraph = false;
-		}
+			// Too wide for any line: split it, keeping at least one
+			// glyph per line
+			for (size_t j = word_start; j < word_start + word_length;)
+			{
+				int size = 1;
+				int codepoint = GetCodepointNext(data + j, &size);
+				float glyph_advance = metrics.advance(codepoint);
 
-		return final;
+				if (line_glyphs > 0 &&
+					metrics.line_width(line_advance + glyph_advance, line_glyphs + 1) > max_width)
+				{
+					wrapped += '\n';
+					line_advance = 0.f;
+					line_glyphs = 0;
+				}
+
+				wrapped.append(data + j, size);
+				line_advance += glyph_advance;
+				line_glyphs++;
+				j += size;
+			}
+		}
 	}
 
 	void TextObject::draw_outline() const
@@ -303,6 +349,20 @@ namespace bacon
 		return CheckCollisionPointRec(p, rect);
 	}
 
+	/**
+	 * Text is anchored at its top-left corner and
+	 * is not rotated with its parent.
+	 */
+	Rectangle TextObject::calculate_bounds() const
+	{
+		Vector2 size = {
+			fmaxf(get_size().x, m_text_extent.x),
+			fmaxf(get_size().y, m_text_extent.y),
+		};
+
+		return get_rotated_bounds(get_position(), size, {0.f, 0.f}, get_rotation());
+	}
+
 	void TextObject::update_ui_buffer() const
 	{
 		Object2D::update_ui_buffer();
@@ -318,39 +378,134 @@ namespace bacon
 	{
 		Object2D::update_from_ui_buffer();
 
+		// Spacing first, since the setters re-layout the text
+		m_char_spacing = ui::obj_properties.char_spacing;
+		m_color = ui::obj_properties.color;
 		set_text(ui::obj_properties.text);
 		set_font(ui::obj_properties.font_path);
 		set_font_size(ui::obj_properties.font_size);
-		m_char_spacing = ui::obj_properties.char_spacing;
-		m_color = ui::obj_properties.color;
 	}
 
+	/**
+	 * Lays the render text out into glyph quads the way
+	 * DrawTextEx() places them, relative to the text origin.
+	 */
+	void TextObject::build_quads(const Font& font) const
+	{
+		m_quads.clear();
+		m_quads_glyphs = font.glyphs;
+		m_quads_texture = font.texture.id;
+		m_quads_dirty = false;
+
+		if (font.glyphs == nullptr || font.baseSize <= 0 || font.texture.id == 0)
+		{
+			return;
+		}
+
+		const float scale = (float)m_font_size / (float)font.baseSize;
+		const float padding = (float)font.glyphPadding;
+		const float texture_width = (float)font.texture.width;
+		const float texture_height = (float)font.texture.height;
+
+		m_quads.reserve(m_render_text.size());
+
+		const char* data = m_render_text.c_str();
+		float offset_x = 0.f;
+		float offset_y = 0.f;
+		for (size_t i = 0; i < m_render_text.size();)
+		{
+			int size = 1;
+			int codepoint = GetCodepointNext(data + i, &size);
+			i += size;
+
+			if (codepoint == '\n')
+			{
+				offset_x = 0.f;
+				offset_y += m_font_size + _LINE_SPACING;
+				continue;
+			}
+
+			int index = GetGlyphIndex(font, codepoint);
+			const GlyphInfo& glyph = font.glyphs[index];
+			const Rectangle& rec = font.recs[index];
+
+			if (codepoint != ' ' && codepoint != '\t')
+			{
+				GlyphQuad quad;
+				quad.dest = {
+					offset_x + (glyph.offsetX - padding) * scale,
+					offset_y + (glyph.offsetY - padding) * scale,
+					(rec.width + 2.f * padding) * scale,
+					(rec.height + 2.f * padding) * scale,
+				};
+				quad.uv = {
+					(rec.x - padding) / texture_width,
+					(rec.y - padding) / texture_height,
+					(rec.width + 2.f * padding) / texture_width,
+					(rec.height + 2.f * padding) / texture_height,
+				};
+				m_quads.push_back(quad);
+			}
+
+			float advance = (glyph.advanceX == 0) ? rec.width : (float)glyph.advanceX;
+			offset_x += advance * scale + m_char_spacing;
+		}
+	}
+
+	/**
+	 * Submits the cached glyph quads, rotated about the text
+	 * origin like DrawTextPro(). Only the transform and color are
+	 * applied per frame.
+	 */
 	void TextObject::draw() const
 	{
-		if (m_font == nullptr)
+		const Font& font = (m_font != nullptr) ? *m_font : GetFontDefault();
+		if (m_quads_dirty || m_quads_glyphs != font.glyphs || m_quads_texture != font.texture.id)
 		{
-			DrawTextPro(
-				GetFontDefault(),
-				m_render_text.c_str(),
-				get_position(),
-				{0, 0},
-				get_rotation(),
-				m_font_size,
-				m_char_spacing,
-				m_color);
+			build_quads(font);
 		}
-		else
+
+		if (m_quads.empty())
 		{
-			DrawTextPro(
-				*m_font,
-				m_render_text.c_str(),
-				get_position(),
-				{0, 0},
-				get_rotation(),
-				m_font_size,
-				m_char_spacing,
-				m_color);
+			return;
+		}
+
+		Vector2 position = get_position();
+		float radians = get_rotation() * DEG2RAD;
+		float cosr = cosf(radians);
+		float sinr = sinf(radians);
+
+		rlSetTexture(font.texture.id);
+		rlBegin(RL_QUADS);
+		rlColor4ub(m_color.r, m_color.g, m_color.b, m_color.a);
+		rlNormal3f(0.f, 0.f, 1.f);
+
+		for (const GlyphQuad& quad : m_quads)
+		{
+			float left = quad.dest.x;
+			float top = quad.dest.y;
+			float right = quad.dest.x + quad.dest.width;
+			float bottom = quad.dest.y + quad.dest.height;
+			float u0 = quad.uv.x;
+			float v0 = quad.uv.y;
+			float u1 = quad.uv.x + quad.uv.width;
+			float v1 = quad.uv.y + quad.uv.height;
+
+			rlTexCoord2f(u0, v0);
+			rlVertex2f(position.x + left * cosr - top * sinr, position.y + left * sinr + top * cosr);
+
+			rlTexCoord2f(u0, v1);
+			rlVertex2f(position.x + left * cosr - bottom * sinr, position.y + left * sinr + bottom * cosr);
+
+			rlTexCoord2f(u1, v1);
+			rlVertex2f(position.x + right * cosr - bottom * sinr, position.y + right * sinr + bottom * cosr);
+
+			rlTexCoord2f(u1, v0);
+			rlVertex2f(position.x + right * cosr - top * sinr, position.y + right * sinr + top * cosr);
 		}
+
+		rlEnd();
+		rlSetTexture(0);
 	}
 
 	void TextObject::draw_properties_editor()
@@ -456,8 +611,8 @@ namespace bacon
 	{
 		Object2D::save_to_json(data);
 
-		data["text"] = m_text;
-		data["font_path"] = m_font_path;
+		data["text"] = std::string(m_text);
+		data["font_path"] = std::string(m_font_path);
 		data["font_size"] = m_font_size;
 		data["char_spacing"] = m_char_spacing;
 		data["color"] = {m_color.r, m_color.g, m_color.b, m_color.a};
@@ -467,37 +622,38 @@ namespace bacon
 	{
 		Object2D::load_from_json(data);
 
-		m_text = json_read_string(data, "text");
-		m_font_path = json_read_string(data, "font_path");
+		std::string text = json_read_string(data, "text");
+		std::string font_path = json_read_string(data, "font_path");
 		m_font_size = json_read_int32(data, "font_size");
 		m_char_spacing = json_read_int32(data, "char_spacing");
 		m_color = json_read_color(data, "color");
 
-		this->set_font(m_font_path);
-		this->set_text(m_text);
+		this->set_font(font_path);
+		this->set_text(text);
 	}
 
-	ByteStream TextObject::serialize() const
+	void TextObject::serialize_to(ByteStream& bytes) const
 	{
-		ByteStream bytes = Object2D::serialize();
+		Object2D::serialize_to(bytes);
 
 		bytes << m_text;
 		bytes << m_font_path;
 		bytes << m_font_size;
 		bytes << m_char_spacing;
 		bytes << m_color.r << m_color.g << m_color.b << m_color.a;
-
-		return bytes;
 	}
 
-	void TextObject::deserialize(ByteStream& bytes)
+	void TextObject::deserialize(ByteView& bytes)
 	{
 		Object2D::deserialize(bytes);
 
-		bytes >> m_text;
-		bytes >> m_font_path;
+		std::string text(bytes.read_string_view());
+		std::string font_path(bytes.read_string_view());
 		bytes >> m_font_size;
 		bytes >> m_char_spacing;
 		bytes >> m_color.r >> m_color.g >> m_color.b >> m_color.a;
+
+		this->set_font(font_path);
+		this->set_text(text);
 	}
 } // namespace bacon
@@ -1,17 +1,23 @@
 #pragma once
 
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
 #include "lib/byte_stream.h"
 #include "raylib.h"
 
+#include "core/2D/glyph_metrics.h"
 #include "core/2D/object_2d.h"
-#include "lib/pool_allocator.h"
+#include "lib/concurrent_pool_allocator.h"
 
 namespace bacon
 {
 	class TextObject : public Object2D
 	{
 	public:
-		static PoolAllocator<TextObject> _allocator;
+		static ConcurrentPoolAllocator<TextObject> _allocator;
 		static void* operator new(size_t size);
 		static void* operator new(size_t size, void* ptr);
 		static void operator delete(void* ptr);
@@ -22,9 +28,11 @@ namespace bacon
 			return obj->get_type_id() == TypeID::TEXT_2D;
 		}
 		static constexpr TypeID static_type_id = TypeID::TEXT_2D;
+		// Extra gap between lines, raylib's default (SetTextLineSpacing)
+		static constexpr int _LINE_SPACING = 2;
 
 		TextObject();
-		TextObject(ByteStream& bytes);
+		TextObject(ByteView& bytes);
 		TextObject(const TextObject& text_object);
 		TextObject& operator=(const TextObject& text_object) = delete;
 		TextObject(TextObject&& text_object) = delete;
@@ -42,9 +50,11 @@ namespace bacon
 		void set_text(const std::string& text);
 		void set_font(const std::string& font_path);
 		void set_font_size(int32_t size);
+		std::string get_font_path() const { return std::string(m_font_path); }
 
 		void draw_outline() const override;
 		bool contains_point(Vector2 point) override;
+		Rectangle calculate_bounds() const override;
 
 		void update_ui_buffer() const override;
 		void update_from_ui_buffer() override;
@@ -53,22 +63,39 @@ namespace bacon
 		void draw_properties_editor() override;
 		void save_to_json(nlohmann::json& data) const override;
 		void load_from_json(const nlohmann::json& data) override;
-		ByteStream serialize() const override;
+		void serialize_to(ByteStream& bytes) const override;
 
 	protected:
-		void deserialize(ByteStream& bytes) override;
+		void deserialize(ByteView& bytes) override;
 
 	private:
-		std::string m_text;
-		std::string m_render_text;
+		std::pmr::string m_text{ObjectMemoryScope::current()};
+		std::pmr::string m_render_text{ObjectMemoryScope::current()};
 		std::shared_ptr<Font> m_font;
-		std::string m_font_path;
+		std::pmr::string m_font_path{ObjectMemoryScope::current()};
 		int32_t m_font_size;
 		int32_t m_char_spacing;
 		Color m_color;
+		Vector2 m_text_extent;
+
+		// One glyph of the cached text mesh, in text-local space
+		typedef struct
+		{
+			Rectangle dest;
+			// Normalized texture coordinates
+			Rectangle uv;
+		} GlyphQuad;
+
+		// Rebuilt on draw after the text, font, size or spacing
+		// changed, or the font was replaced in place (async load)
+		mutable std::pmr::vector<GlyphQuad> m_quads{ObjectMemoryScope::current()};
+		mutable bool m_quads_dirty = true;
+		mutable const GlyphInfo* m_quads_glyphs = nullptr;
+		mutable unsigned int m_quads_texture = 0;
 
 		void update_render_text();
-		float calculate_text_width(const std::string& text);
-		std::string get_wrapped_text(const std::string& text);
+		const GlyphMetrics& get_glyph_metrics() const;
+		void wrap_text(std::string_view text, std::pmr::string& wrapped) const;
+		void build_quads(const Font& font) const;
 	};
 } // namespace bacon
@@ -0,0 +1,83 @@
+#include "core/2D/transform_store_2d.h"
+
+namespace bacon
+{
+	TransformStore2D::TransformStore2D() : m_owner(std::this_thread::get_id())
+	{
+	}
+
+	TransformHandle TransformStore2D::create(Object2D* object)
+	{
+		assert_owner();
+
+		TransformHandle handle;
+		if (!m_free.empty())
+		{
+			handle = m_free.back();
+			m_free.pop_back();
+		}
+		else
+		{
+			handle = (TransformHandle)owner.size();
+			x.push_back(0.f);
+			y.push_back(0.f);
+			w.push_back(0.f);
+			h.push_back(0.f);
+			rotation.push_back(0.f);
+			visible.push_back(0);
+			layer.push_back(0);
+			bounds.push_back({0.f, 0.f, 0.f, 0.f});
+			index_bounds.push_back({0.f, 0.f, 0.f, 0.f});
+			proxy.push_back(_NULL_PROXY);
+			linked.push_back(0);
+			owner.push_back(nullptr);
+		}
+
+		x[handle] = 0.f;
+		y[handle] = 0.f;
+		w[handle] = 1.f;
+		h[handle] = 1.f;
+		rotation[handle] = 0.f;
+		visible[handle] = 1;
+		layer[handle] = 0;
+		bounds[handle] = {0.f, 0.f, 0.f, 0.f};
+		index_bounds[handle] = {0.f, 0.f, 0.f, 0.f};
+		proxy[handle] = _NULL_PROXY;
+		linked[handle] = 0;
+		owner[handle] = object;
+
+		return handle;
+	}
+
+	void TransformStore2D::destroy(TransformHandle handle)
+	{
+		assert_owner();
+
+		if (handle >= owner.size() || owner[handle] == nullptr)
+		{
+			return;
+		}
+
+		owner[handle] = nullptr;
+		visible[handle] = 0;
+		m_free.push_back(handle);
+	}
+
+	void TransformStore2D::reserve(size_t count)
+	{
+		assert_owner();
+
+		x.reserve(count);
+		y.reserve(count);
+		w.reserve(count);
+		h.reserve(count);
+		rotation.reserve(count);
+		visible.reserve(count);
+		layer.reserve(count);
+		bounds.reserve(count);
+		index_bounds.reserve(count);
+		proxy.reserve(count);
+		linked.reserve(count);
+		owner.reserve(count);
+	}
+} // namespace bacon
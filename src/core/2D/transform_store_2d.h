@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "raylib.h"
+
+namespace bacon
+{
+	class Object2D;
+
+	typedef uint32_t TransformHandle;
+
+	/**
+	 * Struct-of-arrays storage for Object2D transforms.
+	 * Every Object2D owns one slot, addressed by a TransformHandle.
+	 * Hot per-frame data (position, size, rotation, bounds) lives in
+	 * contiguous arrays so physics writeback and culling can stream
+	 * over it instead of chasing object pointers.
+	 * Freed slots are reused; a free slot has a null owner.
+	 *
+	 * The store is not synchronized. It belongs to the thread that
+	 * constructed it (the main thread, as Object2D::_transforms is
+	 * a static) and only that thread may create, destroy or touch
+	 * slots. Job system workers must not read or write it; Box2D
+	 * tasks hand their results back through body move events,
+	 * which Scene2D applies on the main thread.
+	 */
+	class TransformStore2D
+	{
+	public:
+		static constexpr TransformHandle _INVALID_HANDLE = UINT32_MAX;
+		// Sentinel for a slot that is not in a spatial index.
+		static constexpr int32_t _NULL_PROXY = -1;
+
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> w;
+		std::vector<float> h;
+		std::vector<float> rotation;
+		std::vector<uint8_t> visible;
+		std::vector<uint32_t> layer;
+		// World-space axis-aligned bounds
+		std::vector<Rectangle> bounds;
+		// Enlarged bounds stored in Scene2D's spatial index under proxy
+		std::vector<Rectangle> index_bounds;
+		std::vector<int32_t> proxy;
+		// Nonzero if the object may have a parent or children, in which
+		// case moving it has to go through Object2D::set_transform.
+		std::vector<uint8_t> linked;
+		std::vector<Object2D*> owner;
+
+		TransformStore2D();
+
+		TransformHandle create(Object2D* object);
+		void destroy(TransformHandle handle);
+		void reserve(size_t count);
+
+		// Number of slots, including free ones
+		size_t capacity() const { return owner.size(); }
+		size_t size() const { return owner.size() - m_free.size(); }
+
+		// Debug check that the caller is the owning thread
+		void assert_owner() const { assert(std::this_thread::get_id() == m_owner); }
+
+	private:
+		std::vector<TransformHandle> m_free;
+		std::thread::id m_owner;
+	};
+} // namespace bacon
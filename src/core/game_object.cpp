@@ -1,11 +1,32 @@
 #include "core/game_object.h"
 
+#include <algorithm>
+
 #include "editor/ui/editor_ui.h"
 #include "util.h"
 
 namespace bacon
 {
-	GameObject* GameObject::create_game_object(ByteStream& bytes)
+	// Null means the default resource
+	static thread_local std::pmr::memory_resource* _object_memory = nullptr;
+
+	ObjectMemoryScope::ObjectMemoryScope(std::pmr::memory_resource* memory)
+	{
+		m_previous = _object_memory;
+		_object_memory = memory;
+	}
+
+	ObjectMemoryScope::~ObjectMemoryScope()
+	{
+		_object_memory = m_previous;
+	}
+
+	std::pmr::memory_resource* ObjectMemoryScope::current()
+	{
+		return (_object_memory != nullptr) ? _object_memory : std::pmr::get_default_resource();
+	}
+
+	GameObject* GameObject::create_game_object(ByteView& bytes)
 	{
 		TypeID type_id;
 		bytes >> type_id;
@@ -59,8 +80,8 @@ namespace bacon
 	void GameObject::copy(const GameObject& object)
 	{
 		m_uuid = object.get_uuid();
-		m_name = object.get_name();
-		m_tag = object.get_tag();
+		m_name = object.m_name;
+		m_tag = object.m_tag;
 	}
 
 	// Default implementations to avoid virtual function call
@@ -146,13 +167,16 @@ namespace bacon
 	 */
 	void GameObject::delete_children()
 	{
-		for (GameObject* child : m_children)
+		// destroy() removes the child from m_children, so
+		// iterate over a detached copy.
+		std::pmr::vector<GameObject*> children(m_children.get_allocator());
+		children.swap(m_children);
+
+		for (GameObject* child : children)
 		{
 			child->destroy();
 			delete child;
 		}
-
-		m_children.clear();
 	}
 
 	void GameObject::clone_children(const GameObject& object, bool add_to_scene)
@@ -195,8 +219,8 @@ namespace bacon
 	{
 		json["type_id"] = static_cast<uint32_t>(m_type_id);
 		json["uuid"] = m_uuid.as_string();
-		json["name"] = m_name;
-		json["tag"] = m_tag;
+		json["name"] = std::string(m_name);
+		json["tag"] = std::string(m_tag);
 
 		for (GameObject* child : m_children)
 		{
@@ -270,49 +294,59 @@ namespace bacon
 	ByteStream GameObject::serialize() const
 	{
 		ByteStream bytes;
+		serialize_to(bytes);
+		return bytes;
+	}
 
+	/**
+	 * Appends the object to bytes. Subclasses write their base
+	 * class first, then their own fields.
+	 */
+	void GameObject::serialize_to(ByteStream& bytes) const
+	{
 		bytes << static_cast<uint32_t>(m_type_id);
 		bytes << m_uuid.as_string();
 		bytes << m_name;
 		bytes << m_tag;
 
-		bytes << m_children.size();
+		// Children are written in place behind a length that is
+		// filled in afterwards, so the tree never gets copied.
+		bytes << (uint64_t)m_children.size();
 		for (GameObject* child : m_children)
 		{
-			bytes << child->serialize().raw();
+			size_t length_position = bytes.begin_length_prefix();
+			child->serialize_to(bytes);
+			bytes.end_length_prefix(length_position);
 		}
-
-		return bytes;
 	}
 
-	void GameObject::deserialize(ByteStream& bytes)
+	void GameObject::deserialize(ByteView& bytes)
 	{
-		std::string uuid_str;
-		bytes >> uuid_str;
-		m_uuid = UUID(uuid_str);
+		m_uuid = UUID(bytes.read_string_view());
 
 		bytes >> m_name;
 		bytes >> m_tag;
 
-		size_t child_count = 0;
+		uint64_t child_count = 0;
 		bytes >> child_count;
-		m_children.reserve(child_count);
-		for (size_t i = 0; i < child_count; ++i)
+		// A corrupt count fails on the first missing child instead
+		m_children.reserve(std::min<uint64_t>(child_count, bytes.remaining()));
+		for (uint64_t i = 0; i < child_count; ++i)
 		{
-			// When we write byte arrays to ByteStream,
-			// we include the size of the array first.
-			// That isn't needed here, so just ignore this.
-			size_t child_size;
+			// Each child is length-prefixed, so a bad child
+			// can be skipped without losing the rest.
+			uint64_t child_size;
 			bytes >> child_size;
+			ByteView child_bytes = bytes.take(child_size);
 
-			GameObject* child = GameObject::create_game_object(bytes);
+			GameObject* child = GameObject::create_game_object(child_bytes);
 			if (!child)
 			{
 				debug_error("Failed to deserialize child object!");
-				return;
+				continue;
 			}
+			// set_parent also adds the child to m_children
 			child->set_parent(this);
-			this->add_child(child);
 		}
 	}
 }
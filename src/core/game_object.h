@@ -1,6 +1,8 @@
 #pragma once
 
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "lib/byte_stream.h"
@@ -42,10 +44,33 @@ namespace bacon
 		return static_cast<T*>(object);
 	}
 
+	/**
+	 * Sets where objects created on this thread allocate their
+	 * members (names, children, scripts, text) for as long as the
+	 * scope lives, e.g. a scene arena while a level loads. Without
+	 * a scope, members come from the default resource.
+	 *
+	 * Members keep the resource they were created with, and copies
+	 * or clones use whichever scope is active when they are made.
+	 */
+	class ObjectMemoryScope
+	{
+	public:
+		explicit ObjectMemoryScope(std::pmr::memory_resource* memory);
+		ObjectMemoryScope(const ObjectMemoryScope& scope) = delete;
+		ObjectMemoryScope& operator=(const ObjectMemoryScope& scope) = delete;
+		~ObjectMemoryScope();
+
+		static std::pmr::memory_resource* current();
+
+	private:
+		std::pmr::memory_resource* m_previous;
+	};
+
 	class GameObject
 	{
 	public:
-		static GameObject* create_game_object(ByteStream& bytes);
+		static GameObject* create_game_object(ByteView& bytes);
 
 		// Everything created is a GameObject
 		static bool classof(const GameObject* object) { return true; }
@@ -73,7 +98,7 @@ namespace bacon
 		virtual void add_child(GameObject* child);
 		virtual void remove_child(GameObject* child);
 		virtual GameObject* get_parent() const { return m_parent; };
-		virtual const std::vector<GameObject*>& get_children() const { return m_children; };
+		virtual const std::pmr::vector<GameObject*>& get_children() const { return m_children; };
 		virtual void delete_children();
 		virtual void clone_children(const GameObject& object, bool add_to_scene);
 
@@ -83,32 +108,35 @@ namespace bacon
 		virtual void draw_properties_editor() = 0;
 		virtual void save_to_json(nlohmann::json& json) const;
 		virtual void load_from_json(const nlohmann::json& json);
-		virtual ByteStream serialize() const = 0;
+		ByteStream serialize() const;
+		virtual void serialize_to(ByteStream& bytes) const;
 
 		template <typename T>
 		bool is() const { return m_type_id == T::static_type_id; }
 
 		TypeID get_type_id() const 			{ return m_type_id; };
 		UUID get_uuid() const 				{ return m_uuid; };
-		std::string get_name() const 		{ return m_name; };
+		std::string get_name() const 		{ return std::string(m_name); };
 		bool get_in_scene() const 			{ return m_in_scene; };
 		void set_in_scene(bool in_scene) 	{ m_in_scene = in_scene; };
-		std::string get_tag() const 		{ return m_tag; };
-		void set_name(std::string name) 	{ m_name = std::move(name); };
-		void set_tag(std::string tag) 		{ m_tag = std::move(tag); };
+		std::string get_tag() const 		{ return std::string(m_tag); };
+		void set_name(std::string_view name) 	{ m_name = name; };
+		void set_tag(std::string_view tag) 		{ m_tag = tag; };
+		// Resource the members were allocated from
+		std::pmr::memory_resource* get_memory() const { return m_children.get_allocator().resource(); }
 		void set_uuid(UUID uuid) 			{ m_uuid = std::move(uuid); };
 
 	protected:
-		virtual void deserialize(ByteStream& bytes);
+		virtual void deserialize(ByteView& bytes);
 
 		TypeID m_type_id;
 		GameObject* m_parent;
-		std::vector<GameObject*> m_children;
+		std::pmr::vector<GameObject*> m_children{ObjectMemoryScope::current()};
 
 	private:
 		UUID m_uuid;
-		std::string m_name;
-		std::string m_tag;
+		std::pmr::string m_name{ObjectMemoryScope::current()};
+		std::pmr::string m_tag{ObjectMemoryScope::current()};
 		bool m_in_scene;
 	};
 } // namespace bacon
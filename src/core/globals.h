@@ -1,13 +1,19 @@
 #pragma once
 
+#include <cstdint>
+#include <memory_resource>
 #include <string>
 
 #include "raylib.h"
 
 #include "editor/editor.h"
+#include "lib/frame_arena.h"
 
 namespace bacon
 {
+	class JobSystem;
+	class ProjectLoader;
+
 	namespace globals
 	{
 		inline std::string engine_version;
@@ -17,12 +23,39 @@ namespace bacon
 
 		inline size_t allocator_block_size = 512;
 
+		// Scratch memory reset at the end of every main loop
+		// iteration. Main thread only.
+		inline FrameArena* frame_arena;
+		inline size_t frame_arena_size = 1 << 20;
+
+		/**
+		 * Resource for data that dies with the frame. Falls back to
+		 * the heap where there is no frame loop (headless, bench).
+		 */
+		inline std::pmr::memory_resource* frame_memory()
+		{
+			if (frame_arena != nullptr)
+			{
+				return frame_arena;
+			}
+			return std::pmr::get_default_resource();
+		}
+
+		// Engine-wide worker threads, shared with Box2D
+		inline JobSystem* job_system;
+
+		// Streams projects in over several frames
+		inline ProjectLoader* project_loader;
+
 		inline bool is_project_loaded;
 		inline bool has_unsaved_changes;
 		inline bool program_running = true;
 		inline std::string project_title = "Untitled Project";
 		inline std::string project_directory;
 		inline std::string project_file;
+		// Render layers, one bit each, whose sprites the renderer
+		// may reorder by texture to batch them. Saved with the project.
+		inline uint32_t texture_sorted_layers = 0;
 
 		inline void update_window_title()
 		{
@@ -36,7 +69,11 @@ namespace bacon
 				window_title += globals::project_title;
 			}
 
-			SetWindowTitle(window_title.c_str());
+			// No window in headless runs
+			if (IsWindowReady())
+			{
+				SetWindowTitle(window_title.c_str());
+			}
 		}
 	} // namespace globals
 } // namespace bacon
@@ -0,0 +1,233 @@
+#include "core/job_system.h"
+
+#include <algorithm>
+
+#include "core/profiler.h"
+#include "core/util.h"
+
+namespace bacon
+{
+	JobSystem::JobSystem(uint32_t worker_count)
+	{
+		if (worker_count == 0)
+		{
+			worker_count = std::max(1u, std::thread::hardware_concurrency());
+		}
+		m_worker_count = std::min(worker_count, _MAX_WORKERS);
+
+		for (JobGroup& group : m_groups)
+		{
+			group.remaining = 0;
+			group.in_use = false;
+		}
+
+		m_pending = 0;
+		m_running = true;
+
+		for (uint32_t i = 0; i < m_worker_count; i++)
+		{
+			m_queues.push_back(std::make_unique<WorkerQueue>());
+		}
+
+		// Worker 0 is the dispatching thread
+		for (uint32_t i = 1; i < m_worker_count; i++)
+		{
+			m_threads.emplace_back(&JobSystem::worker_loop, this, i);
+		}
+
+		debug_log("Job system started with %u workers.", m_worker_count);
+	}
+
+	JobSystem::~JobSystem()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_sleep_mutex);
+			m_running = false;
+		}
+		m_wake.notify_all();
+
+		for (std::thread& thread : m_threads)
+		{
+			thread.join();
+		}
+	}
+
+	/**
+	 * Splits [0, item_count) into ranges of at least min_range items
+	 * and queues them across the workers.
+	 * Returns nullptr if the work was run inline on the caller.
+	 */
+	JobSystem::JobGroup* JobSystem::dispatch(JobFunction function, int item_count, int min_range, void* context)
+	{
+		if (item_count <= 0)
+		{
+			return nullptr;
+		}
+
+		min_range = std::max(min_range, 1);
+		int job_count = std::min((int)m_worker_count, (item_count + min_range - 1) / min_range);
+
+		JobGroup* group = (job_count > 1) ? acquire_group() : nullptr;
+		if (group == nullptr)
+		{
+			function(0, item_count, 0, context);
+			return nullptr;
+		}
+
+		group->remaining = job_count;
+
+		int items_per_job = item_count / job_count;
+		int remainder = item_count % job_count;
+		int start = 0;
+		for (int i = 0; i < job_count; i++)
+		{
+			int count = items_per_job + ((i < remainder) ? 1 : 0);
+			push_job((uint32_t)i, {function, start, start + count, context, group});
+			start += count;
+		}
+
+		// Taking the lock orders this wake-up after a worker's
+		// predicate check, so it can't be missed.
+		{
+			std::lock_guard<std::mutex> lock(m_sleep_mutex);
+		}
+		m_wake.notify_all();
+		return group;
+	}
+
+	void* JobSystem::enqueue_box2d_task(JobFunction task, int item_count, int min_range,
+		void* task_context, void* user_context)
+	{
+		JobSystem* job_system = (JobSystem*)user_context;
+		return job_system->dispatch(task, item_count, min_range, task_context);
+	}
+
+	void JobSystem::finish_box2d_task(void* user_task, void* user_context)
+	{
+		JobSystem* job_system = (JobSystem*)user_context;
+		job_system->wait((JobGroup*)user_task);
+	}
+
+	/**
+	 * Blocks until every job of the group has run.
+	 * The caller executes queued jobs in the meantime.
+	 */
+	void JobSystem::wait(JobGroup* group)
+	{
+		if (group == nullptr)
+		{
+			return;
+		}
+
+		while (group->remaining.load(std::memory_order_acquire) > 0)
+		{
+			Job job;
+			if (pop_job(0, &job))
+			{
+				run_job(job, 0);
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+		}
+
+		group->in_use.store(false, std::memory_order_release);
+	}
+
+	JobSystem::JobGroup* JobSystem::acquire_group()
+	{
+		for (JobGroup& group : m_groups)
+		{
+			bool expected = false;
+			if (group.in_use.compare_exchange_strong(expected, true, std::memory_order_acquire))
+			{
+				return &group;
+			}
+		}
+
+		return nullptr;
+	}
+
+	void JobSystem::push_job(uint32_t queue_index, const Job& job)
+	{
+		WorkerQueue& queue = *m_queues[queue_index % m_worker_count];
+		{
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			queue.jobs.push_back(job);
+		}
+		m_pending.fetch_add(1, std::memory_order_release);
+	}
+
+	/**
+	 * Takes a job from the worker's own queue (newest first),
+	 * otherwise steals the oldest job from another worker.
+	 */
+	bool JobSystem::pop_job(uint32_t worker_index, Job* job)
+	{
+		if (m_pending.load(std::memory_order_acquire) <= 0)
+		{
+			return false;
+		}
+
+		{
+			WorkerQueue& own = *m_queues[worker_index];
+			std::lock_guard<std::mutex> lock(own.mutex);
+			if (!own.jobs.empty())
+			{
+				*job = own.jobs.back();
+				own.jobs.pop_back();
+				m_pending.fetch_sub(1, std::memory_order_relaxed);
+				return true;
+			}
+		}
+
+		for (uint32_t i = 1; i < m_worker_count; i++)
+		{
+			WorkerQueue& victim = *m_queues[(worker_index + i) % m_worker_count];
+			std::lock_guard<std::mutex> lock(victim.mutex);
+			if (!victim.jobs.empty())
+			{
+				*job = victim.jobs.front();
+				victim.jobs.pop_front();
+				m_pending.fetch_sub(1, std::memory_order_relaxed);
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void JobSystem::run_job(const Job& job, uint32_t worker_index)
+	{
+		PROFILE_SCOPE("Job");
+		job.function(job.start, job.end, worker_index, job.context);
+		job.group->remaining.fetch_sub(1, std::memory_order_acq_rel);
+	}
+
+	void JobSystem::worker_loop(uint32_t worker_index)
+	{
+		profiler::set_thread_name("Worker " + std::to_string(worker_index));
+
+		while (true)
+		{
+			Job job;
+			if (pop_job(worker_index, &job))
+			{
+				run_job(job, worker_index);
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(m_sleep_mutex);
+			m_wake.wait(lock, [this]()
+				{
+					return !m_running || m_pending.load(std::memory_order_acquire) > 0;
+				});
+
+			if (!m_running)
+			{
+				return;
+			}
+		}
+	}
+} // namespace bacon
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bacon
+{
+	/**
+	 * Work-stealing job system.
+	 * Each worker owns a deque of jobs: it pops from the back of its
+	 * own queue and steals from the front of the others when empty.
+	 * Worker 0 is the thread that dispatches and waits (normally the
+	 * main thread), which runs jobs while it waits instead of idling.
+	 *
+	 * Only worker 0 may call dispatch() and wait().
+	 */
+	class JobSystem
+	{
+	public:
+		// Runs items [start, end) of a parallel-for
+		typedef void (*JobFunction)(int start, int end, uint32_t worker_index, void* context);
+
+		// Tracks the outstanding jobs of one dispatch
+		typedef struct JobGroup
+		{
+			std::atomic<int> remaining;
+			std::atomic<bool> in_use;
+		} JobGroup;
+
+		static constexpr uint32_t _MAX_WORKERS = 64;
+		static constexpr size_t _MAX_GROUPS = 128;
+
+		// worker_count includes the calling thread; 0 picks the
+		// hardware thread count.
+		explicit JobSystem(uint32_t worker_count = 0);
+		JobSystem(const JobSystem& job_system) = delete;
+		JobSystem& operator=(const JobSystem& job_system) = delete;
+		~JobSystem();
+
+		uint32_t get_worker_count() const { return m_worker_count; }
+
+		JobGroup* dispatch(JobFunction function, int item_count, int min_range, void* context);
+		void wait(JobGroup* group);
+
+		// Box2D's enqueueTask/finishTask callbacks, with the
+		// JobSystem as b2WorldDef::userTaskContext
+		static void* enqueue_box2d_task(JobFunction task, int item_count, int min_range,
+			void* task_context, void* user_context);
+		static void finish_box2d_task(void* user_task, void* user_context);
+
+	private:
+		typedef struct
+		{
+			JobFunction function;
+			int start;
+			int end;
+			void* context;
+			JobGroup* group;
+		} Job;
+
+		typedef struct
+		{
+			std::mutex mutex;
+			std::deque<Job> jobs;
+		} WorkerQueue;
+
+		uint32_t m_worker_count;
+		std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+		std::vector<std::thread> m_threads;
+		JobGroup m_groups[_MAX_GROUPS];
+
+		// Jobs queued but not yet taken, used to park idle workers
+		std::atomic<int> m_pending;
+		std::atomic<bool> m_running;
+		std::mutex m_sleep_mutex;
+		std::condition_variable m_wake;
+
+		JobGroup* acquire_group();
+		void push_job(uint32_t queue_index, const Job& job);
+		bool pop_job(uint32_t worker_index, Job* job);
+		void run_job(const Job& job, uint32_t worker_index);
+		void worker_loop(uint32_t worker_index);
+	};
+} // namespace bacon
@@ -0,0 +1,181 @@
+#include "core/profiler.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+
+#include "nlohmann/json.hpp"
+
+#include "core/util.h"
+
+namespace bacon
+{
+	namespace profiler
+	{
+		static const std::chrono::steady_clock::time_point _epoch = std::chrono::steady_clock::now();
+
+		static std::mutex _registry_mutex;
+		static std::vector<ThreadBuffer*> _thread_buffers;
+		static std::atomic<uint32_t> _next_thread_id = 0;
+
+		static std::mutex _frame_mutex;
+		static RingBuffer<FrameMark> _frames(_FRAME_CAPACITY);
+		static uint64_t _frame_start_ns = 0;
+
+		/**
+		 * The calling thread's buffer, registered on first use.
+		 * Buffers are never freed so the editor can still show
+		 * zones from threads that have exited.
+		 */
+		static ThreadBuffer& get_thread_buffer()
+		{
+			thread_local ThreadBuffer* buffer = nullptr;
+			if (buffer == nullptr)
+			{
+				buffer = new ThreadBuffer();
+				buffer->thread_id = _next_thread_id++;
+				buffer->name = "Thread " + std::to_string(buffer->thread_id);
+
+				std::lock_guard<std::mutex> lock(_registry_mutex);
+				_thread_buffers.push_back(buffer);
+			}
+			return *buffer;
+		}
+
+		uint64_t now_ns()
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now() - _epoch).count();
+		}
+
+		Zone::Zone(const char* name)
+		{
+			m_name = name;
+			m_start_ns = now_ns();
+			get_thread_buffer().depth++;
+		}
+
+		Zone::~Zone()
+		{
+			uint64_t end_ns = now_ns();
+			ThreadBuffer& buffer = get_thread_buffer();
+			buffer.depth--;
+
+			if (paused)
+			{
+				return;
+			}
+
+			std::lock_guard<std::mutex> lock(buffer.mutex);
+			buffer.zones.insert({m_name, m_start_ns, end_ns, buffer.depth});
+		}
+
+		/**
+		 * Closes the previous frame and starts a new one.
+		 * Call once per main loop iteration.
+		 */
+		void begin_frame()
+		{
+			uint64_t now = now_ns();
+
+			if (_frame_start_ns != 0 && !paused)
+			{
+				std::lock_guard<std::mutex> lock(_frame_mutex);
+				_frames.insert({_frame_start_ns, now});
+			}
+			_frame_start_ns = now;
+		}
+
+		void set_thread_name(const std::string& name)
+		{
+			ThreadBuffer& buffer = get_thread_buffer();
+			std::lock_guard<std::mutex> lock(buffer.mutex);
+			buffer.name = name;
+		}
+
+		void copy_frames(std::vector<FrameMark>& frames)
+		{
+			std::lock_guard<std::mutex> lock(_frame_mutex);
+			frames.clear();
+			for (size_t i = 0; i < _frames.size(); i++)
+			{
+				frames.push_back(_frames.at(i));
+			}
+		}
+
+		/**
+		 * Appends the thread's zones that overlap [from_ns, to_ns].
+		 */
+		void copy_zones(ThreadBuffer& buffer, uint64_t from_ns, uint64_t to_ns,
+			std::vector<ZoneEvent>& zones)
+		{
+			std::lock_guard<std::mutex> lock(buffer.mutex);
+			for (size_t i = 0; i < buffer.zones.size(); i++)
+			{
+				const ZoneEvent& zone = buffer.zones.at(i);
+				if (zone.end_ns >= from_ns && zone.start_ns <= to_ns)
+				{
+					zones.push_back(zone);
+				}
+			}
+		}
+
+		std::vector<ThreadBuffer*> get_thread_buffers()
+		{
+			std::lock_guard<std::mutex> lock(_registry_mutex);
+			return _thread_buffers;
+		}
+
+		/**
+		 * Writes every recorded zone as Chrome trace events
+		 * (load in chrome://tracing or Perfetto).
+		 */
+		bool export_chrome_trace(const std::string& path)
+		{
+			using json = nlohmann::json;
+
+			json events = json::array();
+
+			for (ThreadBuffer* buffer : get_thread_buffers())
+			{
+				std::lock_guard<std::mutex> lock(buffer->mutex);
+
+				events.push_back({
+					{"name", "thread_name"},
+					{"ph", "M"},
+					{"pid", 1},
+					{"tid", buffer->thread_id},
+					{"args", {{"name", buffer->name}}},
+				});
+
+				for (size_t i = 0; i < buffer->zones.size(); i++)
+				{
+					const ZoneEvent& zone = buffer->zones.at(i);
+					events.push_back({
+						{"name", zone.name},
+						{"ph", "X"},
+						{"pid", 1},
+						{"tid", buffer->thread_id},
+						{"ts", zone.start_ns / 1000.0},
+						{"dur", (zone.end_ns - zone.start_ns) / 1000.0},
+					});
+				}
+			}
+
+			std::ofstream outfile(path);
+			if (!outfile.is_open())
+			{
+				debug_error("Failed to write trace: %s", path.c_str());
+				return false;
+			}
+
+			json trace;
+			trace["traceEvents"] = events;
+			trace["displayTimeUnit"] = "ms";
+			outfile << trace;
+
+			debug_log("Trace written to %s", path.c_str());
+			return true;
+		}
+	} // namespace profiler
+} // namespace bacon
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "lib/ring_buffer.h"
+
+/*
+ * Scoped-zone profiler.
+ *
+ * PROFILE_SCOPE("name") times the enclosing scope and PROFILE_FUNCTION()
+ * does the same using the function name. PROFILE_FRAME() marks the start
+ * of a new frame. Zone names must be string literals (or otherwise
+ * outlive the profiler), since only the pointer is stored.
+ *
+ * Building without BACON_ENABLE_PROFILER compiles every marker away.
+ */
+
+#define _PROFILE_CONCAT_IMPL(a, b) a##b
+#define _PROFILE_CONCAT(a, b) _PROFILE_CONCAT_IMPL(a, b)
+
+#ifdef BACON_ENABLE_PROFILER
+#define PROFILE_SCOPE(name) ::bacon::profiler::Zone _PROFILE_CONCAT(_profile_zone_, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+#define PROFILE_FRAME() ::bacon::profiler::begin_frame()
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_FUNCTION() ((void)0)
+#define PROFILE_FRAME() ((void)0)
+#endif
+
+namespace bacon
+{
+	namespace profiler
+	{
+		// Zones kept per thread
+		constexpr size_t _ZONE_CAPACITY = 16384;
+		// Frames kept for the history graph
+		constexpr size_t _FRAME_CAPACITY = 512;
+
+		typedef struct
+		{
+			const char* name;
+			uint64_t start_ns;
+			uint64_t end_ns;
+			uint32_t depth;
+		} ZoneEvent;
+
+		typedef struct
+		{
+			uint64_t start_ns;
+			uint64_t end_ns;
+		} FrameMark;
+
+		/**
+		 * Zones recorded by one thread.
+		 * Only the owning thread writes; the mutex lets the
+		 * editor read a consistent copy.
+		 */
+		typedef struct ThreadBuffer
+		{
+			uint32_t thread_id;
+			std::string name;
+			uint32_t depth = 0;
+			std::mutex mutex;
+			RingBuffer<ZoneEvent> zones = RingBuffer<ZoneEvent>(_ZONE_CAPACITY);
+		} ThreadBuffer;
+
+		class Zone
+		{
+		public:
+			explicit Zone(const char* name);
+			~Zone();
+
+			Zone(const Zone& zone) = delete;
+			Zone& operator=(const Zone& zone) = delete;
+
+		private:
+			const char* m_name;
+			uint64_t m_start_ns;
+		};
+
+		// Stops recording so the panel can be inspected
+		inline std::atomic<bool> paused = false;
+
+		uint64_t now_ns();
+		void begin_frame();
+		void set_thread_name(const std::string& name);
+
+		void copy_frames(std::vector<FrameMark>& frames);
+		void copy_zones(ThreadBuffer& buffer, uint64_t from_ns, uint64_t to_ns,
+			std::vector<ZoneEvent>& zones);
+		std::vector<ThreadBuffer*> get_thread_buffers();
+
+		bool export_chrome_trace(const std::string& path);
+	} // namespace profiler
+} // namespace bacon
@@ -33,6 +33,47 @@ namespace bacon
 		return new_point;
 	}
 
+	/**
+	 * Axis-aligned bounds of a rectangle rotated about a pivot.
+	 * origin is the pivot's offset from the rectangle's top-left corner.
+	 */
+	inline Rectangle get_rotated_bounds(Vector2 pivot, Vector2 size, Vector2 origin, float rotation)
+	{
+		float radians = rotation * DEG2RAD;
+		float cosr = cosf(radians);
+		float sinr = sinf(radians);
+
+		Vector2 local[4] = {
+			{-origin.x, -origin.y},
+			{size.x - origin.x, -origin.y},
+			{size.x - origin.x, size.y - origin.y},
+			{-origin.x, size.y - origin.y},
+		};
+
+		Vector2 min = {INFINITY, INFINITY};
+		Vector2 max = {-INFINITY, -INFINITY};
+		for (int i = 0; i < 4; i++)
+		{
+			float x = pivot.x + local[i].x * cosr - local[i].y * sinr;
+			float y = pivot.y + local[i].x * sinr + local[i].y * cosr;
+
+			min.x = fminf(min.x, x);
+			min.y = fminf(min.y, y);
+			max.x = fmaxf(max.x, x);
+			max.y = fmaxf(max.y, y);
+		}
+
+		return {min.x, min.y, max.x - min.x, max.y - min.y};
+	}
+
+	inline bool rect_contains_rect(Rectangle outer, Rectangle inner)
+	{
+		return inner.x >= outer.x &&
+			inner.y >= outer.y &&
+			inner.x + inner.width <= outer.x + outer.width &&
+			inner.y + inner.height <= outer.y + outer.height;
+	}
+
 	inline void DrawRectangleLinesPro(Rectangle rect, float rotation, float thickness, Color color)
 	{
 		float radians = rotation * DEG2RAD;
@@ -1,60 +1,82 @@
 #include "uuid.h"
 
+#include <charconv>
 #include <random>
 
 namespace bacon
 {
-    static std::random_device _random_device;
-    static std::mt19937_64 _random_engine(_random_device());
-    static std::uniform_int_distribution<uint64_t> _uniform_dist;
+    /**
+     * Objects may be created on any thread, so each thread seeds and
+     * draws from its own engine.
+     */
+    static uint64_t random_u64()
+    {
+        thread_local std::mt19937_64 engine(std::random_device{}());
+        std::uniform_int_distribution<uint64_t> dist;
+        return dist(engine);
+    }
 
     UUID::UUID()
     {
-        m_p1 = _uniform_dist(_random_engine);
-        m_p2 = _uniform_dist(_random_engine);
+        m_p1 = random_u64();
+        m_p2 = random_u64();
     }
 
-    UUID::UUID(std::string uuid)
+    /**
+     * Parses a UUID in the "<left>_<right>" format.
+     * Falls back to a random UUID if the string is malformed.
+     */
+    UUID::UUID(std::string_view uuid)
     {
-        if (uuid.empty())
+        size_t pos = uuid.find('_');
+        if (pos != std::string_view::npos)
         {
-            m_p1 = _uniform_dist(_random_engine);
-            m_p2 = _uniform_dist(_random_engine);
-            return;
-        }
+            const char* begin = uuid.data();
+            const char* separator = begin + pos;
+            const char* end = begin + uuid.size();
 
-        size_t pos = uuid.find("_");
-        if (pos == std::string::npos)
-        {
-            m_p1 = _uniform_dist(_random_engine);
-            m_p2 = _uniform_dist(_random_engine);
-            return;
+            // Both fields must be consumed entirely, so "12x_34" is
+            // rejected rather than read as 12_34
+            auto left = std::from_chars(begin, separator, m_p1);
+            auto right = std::from_chars(separator + 1, end, m_p2);
+            if (left.ec == std::errc() && left.ptr == separator &&
+                right.ec == std::errc() && right.ptr == end)
+            {
+                return;
+            }
         }
 
-        std::string p1 = uuid.substr(0, pos);
-        std::string p2 = uuid.substr(pos + 1);
-
-        m_p1 = std::stoull(p1);
-        m_p2 = std::stoull(p2);
+        m_p1 = random_u64();
+        m_p2 = random_u64();
     }
 
     bool UUID::operator==(UUID uuid) const
     {
-        return ((m_p1 == uuid.get_left()) && (m_p2 == uuid.get_right()));
+        return ((m_p1 == uuid.m_p1) && (m_p2 == uuid.m_p2));
     }
 
     std::string UUID::as_string() const
     {
-        return std::to_string(m_p1) + "_" + std::to_string(m_p2);
+        char buffer[_MAX_STRING_LENGTH];
+        return std::string(buffer, write_string(buffer));
     }
 
-    uint64_t UUID::get_left() const
+    /**
+     * Same as as_string(), allocated from `memory`, e.g. the frame
+     * arena for labels that are rebuilt every frame.
+     */
+    std::pmr::string UUID::as_string(std::pmr::memory_resource* memory) const
     {
-        return this->m_p1;
+        char buffer[_MAX_STRING_LENGTH];
+        return std::pmr::string(buffer, write_string(buffer), memory);
     }
 
-    uint64_t UUID::get_right() const
+    size_t UUID::write_string(char* buffer) const
     {
-        return this->m_p2;
+        char* end = std::to_chars(buffer, buffer + 20, m_p1).ptr;
+        *end++ = '_';
+        end = std::to_chars(end, buffer + _MAX_STRING_LENGTH, m_p2).ptr;
+
+        return (size_t)(end - buffer);
     }
 } // namespace bacon
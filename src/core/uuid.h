@@ -1,7 +1,9 @@
 #pragma once
 
 #include <cstdint>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 
 namespace bacon
 {
@@ -9,14 +11,34 @@ namespace bacon
 	{
 	public:
 		UUID();
-		UUID(std::string uuid);
+		UUID(std::string_view uuid);
 		bool operator==(UUID uuid) const;
 		std::string as_string() const;
-		uint64_t get_left() const;
-		uint64_t get_right() const;
+		std::pmr::string as_string(std::pmr::memory_resource* memory) const;
+		uint64_t get_left() const 	{ return m_p1; }
+		uint64_t get_right() const 	{ return m_p2; }
 
 	private:
+		// Two 20 digit numbers and a separator
+		static constexpr size_t _MAX_STRING_LENGTH = 41;
+
 		uint64_t m_p1;
 		uint64_t m_p2;
+
+		size_t write_string(char* buffer) const;
+	};
+
+	/**
+	 * Hashes the raw 128-bit value.
+	 * UUIDs are already uniformly random, so this only folds
+	 * the two halves together.
+	 */
+	struct UUIDHash
+	{
+		size_t operator()(const UUID& uuid) const noexcept
+		{
+			uint64_t hash = uuid.get_left() ^ (uuid.get_right() * 0x9E3779B97F4A7C15ull);
+			return static_cast<size_t>(hash ^ (hash >> 32));
+		}
 	};
 } // namespace bacon
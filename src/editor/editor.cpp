@@ -12,7 +12,9 @@
 #include "rlImGui.h"
 
 #include "core/globals.h"
+#include "core/profiler.h"
 #include "core/util.h"
+#include "file/project_loader.h"
 #include "file/file.h"
 #include "ui/editor_ui.h"
 #include "editor_event.h"
@@ -24,11 +26,15 @@ namespace bacon
 		framerate_limit = globals::editor_ref->get_framerate_limit();
 		project_title = globals::project_title;
 		editor_font_path = globals::editor_font_path;
+		texture_sorted_layers = globals::texture_sorted_layers;
 
 		if (GameState::game_type == GameState::GameType::GAME_2D)
 		{
 			gravity = GameState::state_2d->scene->get_gravity();
 			physics_steps = GameState::state_2d->scene->physics_steps;
+			fixed_timestep = GameState::state_2d->scene->fixed_timestep;
+			physics_rate = GameState::state_2d->scene->physics_rate;
+			max_substeps = GameState::state_2d->scene->max_substeps;
 			pixels_per_meter = GameState::state_2d->scene->get_unit_length();
 		}
 	}
@@ -40,11 +46,15 @@ namespace bacon
 		editor->set_framerate_limit(framerate_limit);
 		globals::project_title = project_title;
 		globals::editor_font_path = editor_font_path;
+		globals::texture_sorted_layers = texture_sorted_layers;
 
 		if (GameState::game_type == GameState::GameType::GAME_2D)
 		{
 			GameState::state_2d->scene->set_gravity(gravity);
 			GameState::state_2d->scene->physics_steps = physics_steps;
+			GameState::state_2d->scene->fixed_timestep = fixed_timestep;
+			GameState::state_2d->scene->physics_rate = physics_rate;
+			GameState::state_2d->scene->max_substeps = max_substeps;
 			GameState::state_2d->scene->set_unit_length(pixels_per_meter);
 		}
 
@@ -194,6 +204,8 @@ namespace bacon
 
 	void Editor::draw_ui()
 	{
+		PROFILE_SCOPE("Editor::draw_ui");
+
 		rlImGuiBegin();
 		ImGui::DockSpaceOverViewport();
 
@@ -202,6 +214,8 @@ namespace bacon
 		ui::draw_object_tree();
 		ui::draw_scene_display();
 		ui::draw_engine_console(this);
+		ui::draw_profiler();
+		ui::draw_assets_panel();
 		ui::draw_settings();
 		ui::draw_general_info_display(this);
 
@@ -225,6 +239,8 @@ namespace bacon
 
 	void Editor::editor_input_2d()
 	{
+		PROFILE_SCOPE("Editor::editor_input_2d");
+
 		static Object2D* click_drag_object = nullptr;
 		static Vector2 last_mouse_position = {0.f, 0.f};
 
@@ -262,22 +278,11 @@ namespace bacon
 			(IsMouseButtonPressed(MOUSE_RIGHT_BUTTON) ||
 			IsMouseLeftDoubleClick()))
 		{
-			// TODO This can be optimized by using iterator over
-			// the object allocators. It's verbose, but faster.
-			bool found = false;
-			for (Object2D* object : GameState::state_2d->scene->get_objects())
-			{
-				if (object->contains_point(mouse_position))
-				{
-					ui::view_properties_object = object;
-					object->update_ui_buffer();
-					found = true;
-					break;
-				}
-			}
-			if (!found)
+			Object2D* object = GameState::state_2d->scene->pick_object(mouse_position);
+			ui::view_properties_object = object;
+			if (object != nullptr)
 			{
-				ui::view_properties_object = nullptr;
+				object->update_ui_buffer();
 			}
 
 			ImGui::SetWindowFocus(NULL);
@@ -337,17 +342,7 @@ namespace bacon
 		// Left click deselect
 		if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) && Editor::cursor_inside_scene_preview)
 		{
-			bool found = false;
-			for (Object2D* object : GameState::state_2d->scene->get_objects())
-			{
-				if (object->contains_point(mouse_position))
-				{
-					found = true;
-					break;
-				}
-			}
-
-			if (!found)
+			if (GameState::state_2d->scene->pick_object(mouse_position) == nullptr)
 			{
 				ui::view_properties_object = nullptr;
 				click_drag_object = nullptr;
@@ -496,6 +491,12 @@ namespace bacon
 
 	void Editor::start_game()
 	{
+		if (globals::project_loader != nullptr && globals::project_loader->is_loading())
+		{
+			debug_log("Wait for the project to finish loading.");
+			return;
+		}
+
 		if (globals::has_unsaved_changes)
 		{
 			ui::show_save_confirm_popup = true;
@@ -520,10 +521,11 @@ namespace bacon
 		this->is_playing = false;
 
 		// Store last object inspected
-		std::string inspect_uuid = "";
-		if (ui::view_properties_object != nullptr)
+		bool restore_inspect = ui::view_properties_object != nullptr;
+		UUID inspect_uuid;
+		if (restore_inspect)
 		{
-			inspect_uuid = ui::view_properties_object->get_uuid().as_string();
+			inspect_uuid = ui::view_properties_object->get_uuid();
 		}
 		ui::view_properties_object = nullptr;
 
@@ -534,7 +536,7 @@ namespace bacon
 		}
 
 		// Restore inspected object
-		if (inspect_uuid.length() > 0)
+		if (restore_inspect)
 		{
 			GameObject* inspect_object = nullptr;
 			if (GameState::state_2d != nullptr && GameState::state_2d->scene != nullptr)
@@ -28,10 +28,14 @@ namespace bacon
 		uint32_t framerate_limit;
 		std::string project_title;
 		std::string editor_font_path;
+		uint32_t texture_sorted_layers;
 
 		float gravity;
 		int physics_steps;
 		float pixels_per_meter;
+		bool fixed_timestep;
+		float physics_rate;
+		int max_substeps;
 
 		EditorSnapshot();
 		void apply();
@@ -1,6 +1,11 @@
 #include "editor_ui.h"
 
+#include <algorithm>
+#include <filesystem>
 #include <fstream>
+#include <map>
+#include <memory_resource>
+#include <string_view>
 
 #include "core/2D/scene_2d.h"
 #include "core/game_object.h"
@@ -20,6 +25,8 @@
 #include "file/file.h"
 #include "core/2D/camera_object.h"
 #include "core/game_state.h"
+#include "core/profiler.h"
+#include "file/project_loader.h"
 
 namespace bacon
 {
@@ -45,15 +52,37 @@ namespace bacon
 		{
 			// Settings window buffers
 			settings::project_title = globals::project_title;
+			settings::texture_sorted_layers = globals::texture_sorted_layers;
 			if (GameState::state_2d != nullptr && GameState::state_2d->scene != nullptr)
 			{
 				settings::gravity = GameState::state_2d->scene->get_gravity();
 				settings::physics_steps = GameState::state_2d->scene->physics_steps;
+				settings::fixed_timestep = GameState::state_2d->scene->fixed_timestep;
+				settings::physics_rate = GameState::state_2d->scene->physics_rate;
+				settings::max_substeps = GameState::state_2d->scene->max_substeps;
 				settings::pixels_per_meter =
 					GameState::state_2d->scene->get_unit_length();
+				settings::sprite_atlas =
+					GameState::state_2d->assets->is_sprite_atlas_enabled();
 			}
 		}
 
+		/**
+		 * Asks for a project file and streams it in over the
+		 * next frames.
+		 */
+		static void load_project_from_dialog()
+		{
+			std::string file_path;
+			if (file::pick_project_file(file_path) != NFD_OKAY)
+			{
+				return;
+			}
+
+			view_properties_object = nullptr;
+			globals::project_loader->begin(file_path);
+		}
+
 		void draw_top_bar(Editor* editor)
 		{
 			ImGui::BeginMainMenuBar();
@@ -79,6 +108,28 @@ namespace bacon
 					ui::editor_open_project(editor);
 				}
 
+				if (ImGui::BeginMenu("Export Project", globals::is_project_loaded))
+				{
+					std::filesystem::path project_path = globals::project_file;
+
+					if (ImGui::MenuItem("Binary (.bproj)"))
+					{
+						file::export_project(project_path.replace_extension(".bproj").string());
+					}
+
+					if (ImGui::MenuItem("JSON (.json)"))
+					{
+						file::export_project(project_path.replace_extension(".json").string());
+					}
+
+					ImGui::EndMenu();
+				}
+
+				if (ImGui::MenuItem("Import Assets", NULL, false, globals::is_project_loaded))
+				{
+					file::import_project_assets();
+				}
+
 				ImGui::Separator();
 
 				if (ImGui::MenuItem("Settings"))
@@ -127,6 +178,9 @@ namespace bacon
 					ui::show_save_confirm_popup = true;
 				}
 
+				ImGui::MenuItem("Profiler", NULL, &show_profiler);
+				ImGui::MenuItem("Assets", NULL, &show_assets);
+
 				ImGui::EndMenu();
 			}
 			ImGui::EndMainMenuBar();
@@ -408,6 +462,54 @@ namespace bacon
 						push_event(event);
 					}
 
+					ImGui::ItemLabel("Fixed Timestep:", ItemLabelFlag::Left);
+					if (ImGui::Checkbox("##fixed_timestep", &settings::fixed_timestep))
+					{
+						globals::has_unsaved_changes = true;
+						EditorEvent* event = new EditorEvent();
+						event->before = new EditorSnapshot();
+
+						scene->fixed_timestep = settings::fixed_timestep;
+
+						event->after = new EditorSnapshot();
+						push_event(event);
+					}
+
+					ImGui::ItemLabel("Physics Rate (Hz):", ItemLabelFlag::Left);
+					ImGui::InputFloat("##physics_rate", &settings::physics_rate);
+					if (ImGui::IsItemDeactivatedAfterEdit())
+					{
+						if (settings::physics_rate <= 0.f)
+						{
+							settings::physics_rate = scene->physics_rate;
+						}
+
+						globals::has_unsaved_changes = true;
+						EditorEvent* event = new EditorEvent();
+						event->before = new EditorSnapshot();
+
+						scene->physics_rate = settings::physics_rate;
+
+						event->after = new EditorSnapshot();
+						push_event(event);
+					}
+
+					ImGui::ItemLabel("Max Substeps:", ItemLabelFlag::Left);
+					ImGui::InputInt("##max_substeps", &settings::max_substeps);
+					if (ImGui::IsItemDeactivatedAfterEdit())
+					{
+						settings::max_substeps = std::max(settings::max_substeps, 1);
+
+						globals::has_unsaved_changes = true;
+						EditorEvent* event = new EditorEvent();
+						event->before = new EditorSnapshot();
+
+						scene->max_substeps = settings::max_substeps;
+
+						event->after = new EditorSnapshot();
+						push_event(event);
+					}
+
 					ImGui::ItemLabel("Pixels per Meter:", ItemLabelFlag::Left);
 					ImGui::InputFloat("##units_per_meter", &settings::pixels_per_meter);
 					if (ImGui::IsItemDeactivatedAfterEdit())
@@ -422,6 +524,57 @@ namespace bacon
 						push_event(event);
 					}
 
+					ImGui::ItemLabel("Sprite Atlas:", ItemLabelFlag::Left);
+					if (ImGui::Checkbox("##sprite_atlas", &settings::sprite_atlas))
+					{
+						globals::has_unsaved_changes = true;
+
+						AssetManager2D* assets = GameState::state_2d->assets;
+						if (settings::sprite_atlas)
+						{
+							assets->build_sprite_atlas(globals::project_directory + "/sprites");
+						}
+						else
+						{
+							assets->clear_sprite_atlas();
+						}
+
+						// Re-resolve textures against the new atlas
+						for (Entity2D* entity : scene->get_entities())
+						{
+							entity->set_texture(entity->get_texture_path());
+						}
+					}
+
+					ImGui::ItemLabel("Sort Layers by Texture:", ItemLabelFlag::Left);
+					bool sorted_layers_changed = false;
+					for (size_t i = 0; i < Renderer2D::_MAX_LAYERS; i++)
+					{
+						char label[8];
+						snprintf(label, sizeof(label), "%zu", i);
+						if (i > 0)
+						{
+							ImGui::SameLine();
+						}
+						sorted_layers_changed |= ImGui::CheckboxFlags(label,
+							&settings::texture_sorted_layers, 1u << i);
+					}
+					ImGui::SameLine();
+					ImGui::HelpMarker("Sprites in these layers are reordered by texture to "
+						"batch more of them, so overlapping sprites with different "
+						"textures may swap. Text and untextured objects keep their place.");
+					if (sorted_layers_changed)
+					{
+						globals::has_unsaved_changes = true;
+						EditorEvent* event = new EditorEvent();
+						event->before = new EditorSnapshot();
+
+						globals::texture_sorted_layers = settings::texture_sorted_layers;
+
+						event->after = new EditorSnapshot();
+						push_event(event);
+					}
+
 					ImGui::EndTabItem();
 				}
 
@@ -431,14 +584,337 @@ namespace bacon
 			ImGui::End();
 		}
 
+		/**
+		 * Frame-time history, a timeline of the last complete frame
+		 * per thread, and per-zone totals for that frame.
+		 */
+		void draw_profiler()
+		{
+			if (!ui::show_profiler)
+				return;
+
+			ImGui::Begin("Profiler", &ui::show_profiler, global_window_flags);
+
+#ifndef BACON_ENABLE_PROFILER
+			ImGui::TextDisabled("Profiler is disabled in this build (BACON_PROFILER=OFF).");
+			ImGui::End();
+			return;
+#else
+			typedef struct
+			{
+				uint64_t total_ns;
+				uint32_t calls;
+			} ZoneTotal;
+
+			static std::vector<profiler::FrameMark> frames;
+			static std::vector<profiler::ZoneEvent> zones;
+			static std::vector<float> frame_ms;
+
+			bool paused = profiler::paused;
+			if (ImGui::Checkbox("Pause", &paused))
+			{
+				profiler::paused = paused;
+			}
+
+			ImGui::SameLine();
+			if (ImGui::Button("Export Chrome Trace"))
+			{
+				std::string directory = globals::project_directory.empty()
+					? std::string(".") : globals::project_directory;
+				profiler::export_chrome_trace(directory + "/profiler_trace.json");
+			}
+
+			profiler::copy_frames(frames);
+			if (frames.empty())
+			{
+				ImGui::Text("No frames recorded yet.");
+				ImGui::End();
+				return;
+			}
+
+			frame_ms.clear();
+			for (const profiler::FrameMark& frame : frames)
+			{
+				frame_ms.push_back((frame.end_ns - frame.start_ns) / 1000000.f);
+			}
+
+			const profiler::FrameMark& last = frames.back();
+			float last_ms = frame_ms.back();
+			float max_ms = *std::max_element(frame_ms.begin(), frame_ms.end());
+
+			char overlay[32];
+			snprintf(overlay, sizeof(overlay), "%.2f ms", last_ms);
+			ImGui::PlotLines("##frame_times", frame_ms.data(), (int)frame_ms.size(), 0,
+				overlay, 0.f, max_ms * 1.1f, ImVec2(-1.f, 60.f));
+
+			// Timeline
+			const float row_height = 18.f;
+			const float label_width = 90.f;
+			const double frame_ns = (double)(last.end_ns - last.start_ns);
+
+			// Zone names are literals, so views of them make fine keys
+			std::pmr::map<std::string_view, ZoneTotal> totals(globals::frame_memory());
+
+			for (profiler::ThreadBuffer* buffer : profiler::get_thread_buffers())
+			{
+				zones.clear();
+				profiler::copy_zones(*buffer, last.start_ns, last.end_ns, zones);
+				if (zones.empty())
+					continue;
+
+				uint32_t max_depth = 0;
+				for (const profiler::ZoneEvent& zone : zones)
+				{
+					max_depth = std::max(max_depth, zone.depth);
+				}
+
+				std::pmr::string name(globals::frame_memory());
+				{
+					std::lock_guard<std::mutex> lock(buffer->mutex);
+					name = buffer->name;
+				}
+
+				ImVec2 origin = ImGui::GetCursorScreenPos();
+				float width = std::max(ImGui::GetContentRegionAvail().x - label_width, 1.f);
+				float height = row_height * (max_depth + 1);
+
+				ImDrawList* draw_list = ImGui::GetWindowDrawList();
+				draw_list->AddText(origin, IM_COL32(255, 255, 255, 255), name.c_str());
+
+				ImVec2 mouse = ImGui::GetMousePos();
+				for (const profiler::ZoneEvent& zone : zones)
+				{
+					uint64_t start = std::max(zone.start_ns, last.start_ns);
+					uint64_t end = std::min(zone.end_ns, last.end_ns);
+
+					float x0 = origin.x + label_width + (float)((start - last.start_ns) / frame_ns) * width;
+					float x1 = origin.x + label_width + (float)((end - last.start_ns) / frame_ns) * width;
+					x1 = std::max(x1, x0 + 1.f);
+					float y0 = origin.y + zone.depth * row_height;
+					float y1 = y0 + row_height - 1.f;
+
+					// Colour by name so a zone keeps its colour between frames
+					ImU32 hash = ImHashStr(zone.name);
+					ImU32 color = IM_COL32(80 + (hash & 0x7f), 80 + ((hash >> 8) & 0x7f), 80 + ((hash >> 16) & 0x7f), 255);
+					draw_list->AddRectFilled(ImVec2(x0, y0), ImVec2(x1, y1), color);
+
+					if (x1 - x0 > 30.f)
+					{
+						draw_list->PushClipRect(ImVec2(x0, y0), ImVec2(x1, y1), true);
+						draw_list->AddText(ImVec2(x0 + 2.f, y0 + 1.f), IM_COL32(0, 0, 0, 255), zone.name);
+						draw_list->PopClipRect();
+					}
+
+					float duration_ms = (zone.end_ns - zone.start_ns) / 1000000.f;
+					if (ImGui::IsWindowHovered() &&
+						mouse.x >= x0 && mouse.x < x1 && mouse.y >= y0 && mouse.y < y1)
+					{
+						ImGui::SetTooltip("%s\n%.3f ms", zone.name, duration_ms);
+					}
+
+					ZoneTotal& total = totals[zone.name];
+					total.total_ns += zone.end_ns - zone.start_ns;
+					total.calls++;
+				}
+
+				ImGui::Dummy(ImVec2(label_width + width, height + 4.f));
+			}
+
+			ImGui::Separator();
+
+			if (ImGui::BeginTable("##zone_totals", 4,
+				ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp))
+			{
+				ImGui::TableSetupColumn("Zone");
+				ImGui::TableSetupColumn("Calls");
+				ImGui::TableSetupColumn("Total (ms)");
+				ImGui::TableSetupColumn("% of frame");
+				ImGui::TableHeadersRow();
+
+				for (const auto& [name, total] : totals)
+				{
+					ImGui::TableNextRow();
+					ImGui::TableNextColumn();
+					ImGui::Text("%.*s", (int)name.size(), name.data());
+					ImGui::TableNextColumn();
+					ImGui::Text("%u", total.calls);
+					ImGui::TableNextColumn();
+					ImGui::Text("%.3f", total.total_ns / 1000000.0);
+					ImGui::TableNextColumn();
+					ImGui::Text("%.1f", 100.0 * total.total_ns / frame_ns);
+				}
+
+				ImGui::EndTable();
+			}
+
+			ImGui::End();
+#endif
+		}
+
+		/**
+		 * Cache usage against the budget, hit/miss counts and the
+		 * size and holders of every cached asset.
+		 */
+		void draw_assets_panel()
+		{
+			if (!ui::show_assets)
+				return;
+
+			ImGui::Begin("Assets", &ui::show_assets, global_window_flags);
+
+			if (GameState::state_2d == nullptr || GameState::state_2d->assets == nullptr)
+			{
+				ImGui::Text("No 2D project loaded.");
+				ImGui::End();
+				return;
+			}
+
+			AssetManager2D* assets = GameState::state_2d->assets;
+			const float megabyte = 1024.f * 1024.f;
+
+			int budget_mb = (int)(assets->memory_budget / (size_t)megabyte);
+			ImGui::ItemLabel("Budget (MB)", ItemLabelFlag::Left);
+			if (ImGui::InputInt("##asset_budget", &budget_mb))
+			{
+				assets->memory_budget = (size_t)std::max(budget_mb, 0) * (size_t)megabyte;
+			}
+
+			float used_mb = assets->get_memory_used() / megabyte;
+			char usage[64];
+			if (assets->memory_budget > 0)
+			{
+				snprintf(usage, sizeof(usage), "%.1f / %d MB", used_mb, budget_mb);
+				ImGui::ProgressBar(std::min(used_mb / (float)std::max(budget_mb, 1), 1.f),
+					ImVec2(-1.f, 0.f), usage);
+			}
+			else
+			{
+				snprintf(usage, sizeof(usage), "%.1f MB (no budget)", used_mb);
+				ImGui::ProgressBar(0.f, ImVec2(-1.f, 0.f), usage);
+			}
+
+			uint64_t hits = assets->get_hits();
+			uint64_t misses = assets->get_misses();
+			uint64_t requests = hits + misses;
+			ImGui::Text("Hits: %llu  Misses: %llu  Hit rate: %.1f%%",
+				(unsigned long long)hits, (unsigned long long)misses,
+				requests > 0 ? 100.0 * hits / requests : 0.0);
+			ImGui::Text("Evictions: %llu  Loading: %zu",
+				(unsigned long long)assets->get_evictions(), assets->get_pending_count());
+
+			if (ImGui::Button("Evict Unused"))
+			{
+				assets->evict_unused();
+			}
+
+			const std::shared_ptr<AssetCache>& import_cache = assets->get_import_cache();
+			if (import_cache != nullptr)
+			{
+				ImGui::Text("Import cache: %llu hits, %llu misses, %llu written",
+					(unsigned long long)import_cache->get_hits(),
+					(unsigned long long)import_cache->get_misses(),
+					(unsigned long long)import_cache->get_writes());
+				ImGui::SameLine();
+				if (ImGui::Button("Clear"))
+				{
+					import_cache->clear();
+				}
+			}
+
+			std::vector<AssetInfo> info = assets->get_asset_info();
+			std::sort(info.begin(), info.end(), [](const AssetInfo& a, const AssetInfo& b)
+				{
+					return a.bytes > b.bytes;
+				});
+
+			if (ImGui::BeginTable("##asset_table", 5,
+				ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY |
+				ImGuiTableFlags_SizingStretchProp))
+			{
+				ImGui::TableSetupScrollFreeze(0, 1);
+				ImGui::TableSetupColumn("Asset");
+				ImGui::TableSetupColumn("Size (KB)");
+				ImGui::TableSetupColumn("Users");
+				ImGui::TableSetupColumn("Hits");
+				ImGui::TableSetupColumn("Idle (frames)");
+				ImGui::TableHeadersRow();
+
+				for (const AssetInfo& asset : info)
+				{
+					std::string name = file::abs_path_to_relative(asset.path);
+					if (asset.is_font)
+					{
+						name += " (font)";
+					}
+
+					ImGui::TableNextRow();
+					ImGui::TableNextColumn();
+					if (asset.pending)
+					{
+						ImGui::TextDisabled("%s (loading)", name.c_str());
+					}
+					else
+					{
+						ImGui::Text("%s", name.c_str());
+					}
+					ImGui::TableNextColumn();
+					ImGui::Text("%.1f", asset.bytes / 1024.f);
+					ImGui::TableNextColumn();
+					ImGui::Text("%ld", asset.users);
+					ImGui::TableNextColumn();
+					ImGui::Text("%u", asset.hits);
+					ImGui::TableNextColumn();
+					ImGui::Text("%llu", (unsigned long long)(assets->get_frame() - asset.last_used));
+				}
+
+				ImGui::EndTable();
+			}
+
+			ImGui::End();
+		}
+
 		void draw_general_info_display(Editor* editor)
 		{
 			ImGui::Begin("Info", &show_general_info, global_window_flags);
 			int fps = GetFPS();
-			std::string title = "Bacon Engine " + globals::engine_version;
-			ImGui::Text("%s", title.c_str());
+			ImGui::Text("Bacon Engine %s", globals::engine_version.c_str());
 			ImGui::Text("FPS: %i", fps);
 
+			ProjectLoader* loader = globals::project_loader;
+			if (loader != nullptr && loader->is_loading())
+			{
+				char progress[64];
+				snprintf(progress, sizeof(progress), "Loading %zu / %zu",
+					loader->get_loaded_count(), loader->get_total_count());
+				ImGui::ProgressBar(loader->get_progress(), ImVec2(-1.f, 0.f), progress);
+			}
+
+			// Last completed frame, since this one is still allocating
+			FrameArena* arena = globals::frame_arena;
+			if (arena != nullptr)
+			{
+				ImGui::Text("Frame arena: %.1f / %.1f KB (peak %.1f KB)",
+					arena->get_last_used() / 1024.f,
+					arena->get_capacity() / 1024.f,
+					arena->get_high_water() / 1024.f);
+				if (arena->get_overflow_frames() > 0)
+				{
+					ImGui::TextColored(ImVec4(1.f, 0.6f, 0.2f, 1.f), "Overflowed in %llu frames",
+						(unsigned long long)arena->get_overflow_frames());
+				}
+			}
+
+			if (GameState::state_2d != nullptr && GameState::state_2d->renderer != nullptr)
+			{
+				Renderer2D* renderer = GameState::state_2d->renderer;
+				const RenderStats& stats = renderer->get_stats();
+				ImGui::Text("Objects drawn: %u (culled: %u)", stats.drawn, stats.culled);
+				ImGui::Text("Draw batches: %u", stats.draw_calls);
+
+				ImGui::ItemLabel("View Culling", ItemLabelFlag::Left);
+				ImGui::Checkbox("##view_culling", &renderer->cull_objects);
+			}
+
 			ImGui::Separator();
 
 			if (editor->is_playing)
@@ -659,7 +1135,7 @@ namespace bacon
 
 						case LastEditorAction::PROJECT_OPEN:
 						{
-							file::load_project(true);
+							load_project_from_dialog();
 							break;
 						}
 
@@ -916,8 +1392,9 @@ namespace bacon
 				ImGui::EndDragDropTarget();
 			}
 
-			// Display children if open
-			auto children = object->get_children();
+			// Display children if open. Copied, since drag and drop can
+			// reparent while the list is walked.
+			std::pmr::vector<GameObject*> children(object->get_children(), globals::frame_memory());
 			if (children.size() > 0 && is_open)
 			{
 				ImGui::Indent(4);
@@ -1000,7 +1477,7 @@ namespace bacon
 			}
 			else
 			{
-				file::load_project(true);
+				load_project_from_dialog();
 			}
 		}
 
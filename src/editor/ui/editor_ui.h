@@ -26,7 +26,12 @@ namespace bacon
 
 			inline float gravity;
 			inline int physics_steps;
+			inline bool fixed_timestep;
+			inline float physics_rate;
+			inline int max_substeps;
 			inline float pixels_per_meter;
+			inline bool sprite_atlas;
+			inline unsigned int texture_sorted_layers;
 		} // namespace settings
 
 		typedef struct ObjectFields
@@ -82,6 +87,8 @@ namespace bacon
 		inline bool show_console = true;
 		inline bool show_settings = false;
 		inline bool show_general_info = true;
+		inline bool show_profiler = false;
+		inline bool show_assets = false;
 
 		inline bool show_entity_create = false;
 		inline bool show_text_create = false;
@@ -109,6 +116,8 @@ namespace bacon
 		void draw_engine_console(Editor* editor);
 		void draw_settings();
 		void draw_general_info_display(Editor* editor);
+		void draw_profiler();
+		void draw_assets_panel();
 
 		void draw_entity_create();
 		void draw_text_create();
@@ -0,0 +1,729 @@
+#include "file/asset_cache.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <initializer_list>
+#include <thread>
+#include <vector>
+
+#include "core/globals.h"
+#include "core/job_system.h"
+#include "core/profiler.h"
+#include "core/util.h"
+#include "lib/byte_stream.h"
+#include "lib/hash.h"
+
+namespace bacon
+{
+	// value, offsetX, offsetY, advanceX and the atlas rectangle
+	static constexpr size_t _GLYPH_BYTES = sizeof(int32_t) * 4 + sizeof(float) * 4;
+
+	typedef struct
+	{
+		int32_t value;
+		int32_t offset_x;
+		int32_t offset_y;
+		int32_t advance_x;
+		Rectangle rec;
+	} GlyphEntry;
+
+	static bool has_extension(const std::string& path, std::initializer_list<const char*> extensions)
+	{
+		std::string extension = std::filesystem::path(path).extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+		for (const char* candidate : extensions)
+		{
+			if (extension == candidate)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	static bool is_image_file(const std::string& path)
+	{
+		return has_extension(path, {".png", ".jpg", ".jpeg"});
+	}
+
+	static bool stat_source(const std::string& path, AssetCache::SourceInfo& source)
+	{
+		namespace fs = std::filesystem;
+
+		std::error_code error;
+		source.size = (uint64_t)fs::file_size(path, error);
+		if (error)
+		{
+			return false;
+		}
+
+		source.mtime = (int64_t)fs::last_write_time(path, error).time_since_epoch().count();
+		source.content_hash = 0;
+		return !error;
+	}
+
+	static bool hash_source(const std::string& path, uint64_t& hash)
+	{
+		MappedFile file;
+		if (!file.open(path))
+		{
+			return false;
+		}
+
+		hash = fnv1a_64(file.data(), file.size());
+		return true;
+	}
+
+	/**
+	 * Bytes taken by an image and its mip chain, matching
+	 * the layout ImageMipmaps() produces.
+	 */
+	static size_t image_data_size(int width, int height, int format, int mipmaps)
+	{
+		size_t size = 0;
+		for (int i = 0; i < mipmaps; i++)
+		{
+			size += (size_t)GetPixelDataSize(width, height, format);
+			width = std::max(width / 2, 1);
+			height = std::max(height / 2, 1);
+		}
+		return size;
+	}
+
+	/**
+	 * Points image at pixels stored in the view, without copying.
+	 */
+	static bool read_image_block(ByteView& bytes, Image& image)
+	{
+		int32_t width, height, format, mipmaps;
+		uint64_t data_size;
+		bytes >> width >> height >> format >> mipmaps >> data_size;
+
+		if (width <= 0 || height <= 0 || mipmaps <= 0 ||
+			format < PIXELFORMAT_UNCOMPRESSED_GRAYSCALE ||
+			format > PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 ||
+			data_size != image_data_size(width, height, format, mipmaps))
+		{
+			return false;
+		}
+
+		ByteView pixels = bytes.take((size_t)data_size);
+		image.data = (void*)pixels.data();
+		image.width = width;
+		image.height = height;
+		image.format = format;
+		image.mipmaps = mipmaps;
+		return true;
+	}
+
+	AssetCache::AssetCache(const std::string& project_directory, bool mipmaps)
+	{
+		namespace fs = std::filesystem;
+
+		std::error_code error;
+		fs::path directory = fs::weakly_canonical(project_directory, error);
+		if (error)
+		{
+			directory = project_directory;
+		}
+
+		m_project_directory = directory.generic_string();
+		m_cache_directory = (directory / _CACHE_DIR).generic_string();
+		m_mipmaps = mipmaps;
+	}
+
+	/**
+	 * Maps the cached pixels of an image.
+	 * Returns false if there is no current entry.
+	 */
+	bool AssetCache::read_image(const std::string& path, CachedImage& image)
+	{
+		PROFILE_SCOPE("AssetCache::read_image");
+
+		std::shared_ptr<MappedFile> file;
+		ByteView body;
+		bool found = false;
+		if (open_entry(path, entry_path(path, ".btex"), _TEXTURE_MAGIC, file, body))
+		{
+			try
+			{
+				found = read_image_block(body, image.image) && accepts_mipmaps(image.image.mipmaps);
+			}
+			catch (const std::out_of_range&)
+			{
+				found = false;
+			}
+		}
+
+		if (!found)
+		{
+			m_misses++;
+			return false;
+		}
+
+		image.file = file;
+		m_hits++;
+		return true;
+	}
+
+	/**
+	 * Rebuilds a baked font without touching the GPU: the glyph
+	 * metrics and images are filled in and the atlas is left in
+	 * `atlas` for the caller to upload as font.texture.
+	 */
+	bool AssetCache::read_font(const std::string& path, CachedImage& atlas, Font& font)
+	{
+		if (!is_bakeable_font(path))
+		{
+			return false;
+		}
+
+		PROFILE_SCOPE("AssetCache::read_font");
+
+		std::shared_ptr<MappedFile> file;
+		ByteView body;
+		if (!open_entry(path, entry_path(path, ".bfnt"), _FONT_MAGIC, file, body))
+		{
+			m_misses++;
+			return false;
+		}
+
+		int32_t base_size, glyph_count, glyph_padding;
+		std::vector<GlyphEntry> glyphs;
+		Image image = {0};
+		try
+		{
+			body >> base_size >> glyph_count >> glyph_padding;
+			if (base_size <= 0 || glyph_count <= 0 ||
+				(size_t)glyph_count * _GLYPH_BYTES > body.remaining())
+			{
+				m_misses++;
+				return false;
+			}
+
+			glyphs.resize(glyph_count);
+			for (GlyphEntry& glyph : glyphs)
+			{
+				body >> glyph.value >> glyph.offset_x >> glyph.offset_y >> glyph.advance_x;
+				body >> glyph.rec.x >> glyph.rec.y >> glyph.rec.width >> glyph.rec.height;
+			}
+
+			if (!read_image_block(body, image) || image.mipmaps != 1)
+			{
+				m_misses++;
+				return false;
+			}
+		}
+		catch (const std::out_of_range&)
+		{
+			m_misses++;
+			return false;
+		}
+
+		for (const GlyphEntry& glyph : glyphs)
+		{
+			if (glyph.rec.x < 0 || glyph.rec.y < 0 ||
+				glyph.rec.x + glyph.rec.width > image.width ||
+				glyph.rec.y + glyph.rec.height > image.height)
+			{
+				m_misses++;
+				return false;
+			}
+		}
+
+		// Allocated with raylib's allocator so UnloadFont() can free them
+		font = {0};
+		font.baseSize = base_size;
+		font.glyphCount = glyph_count;
+		font.glyphPadding = glyph_padding;
+		font.glyphs = (GlyphInfo*)MemAlloc(sizeof(GlyphInfo) * glyph_count);
+		font.recs = (Rectangle*)MemAlloc(sizeof(Rectangle) * glyph_count);
+		for (int32_t i = 0; i < glyph_count; i++)
+		{
+			font.recs[i] = glyphs[i].rec;
+			font.glyphs[i].value = glyphs[i].value;
+			font.glyphs[i].offsetX = glyphs[i].offset_x;
+			font.glyphs[i].offsetY = glyphs[i].offset_y;
+			font.glyphs[i].advanceX = glyphs[i].advance_x;
+			// Same as LoadFontFromMemory(), for ImageDrawText()
+			font.glyphs[i].image = ImageFromImage(image, glyphs[i].rec);
+		}
+
+		atlas.file = file;
+		atlas.image = image;
+		m_hits++;
+		return true;
+	}
+
+	/**
+	 * Decodes an image from its source file and caches the result.
+	 * Returns an image the caller owns, empty on failure.
+	 */
+	Image AssetCache::decode_image(const std::string& path)
+	{
+		PROFILE_SCOPE("AssetCache::decode_image");
+
+		Image image = {0};
+
+		// Stat before reading so a concurrent edit leaves the
+		// entry stale rather than wrong
+		SourceInfo source;
+		MappedFile file;
+		if (!stat_source(path, source) || !file.open(path) || file.size() == 0)
+		{
+			return image;
+		}
+		source.content_hash = fnv1a_64(file.data(), file.size());
+
+		image = LoadImageFromMemory(GetFileExtension(path.c_str()), file.data(), (int)file.size());
+		if (image.data == nullptr)
+		{
+			return image;
+		}
+
+		if (m_mipmaps)
+		{
+			ImageMipmaps(&image);
+		}
+
+		if (!write_image(path, image, source))
+		{
+			debug_error("Failed to cache image: %s", path.c_str());
+		}
+
+		return image;
+	}
+
+	/**
+	 * Rasterizes a TTF/OTF font and caches it. Like decode_image(),
+	 * the caller owns the result: unload `atlas` with UnloadImage()
+	 * once it is uploaded.
+	 */
+	bool AssetCache::decode_font(const std::string& path, Font& font, Image& atlas)
+	{
+		PROFILE_SCOPE("AssetCache::decode_font");
+
+		font = {0};
+		atlas = {0};
+
+		SourceInfo source;
+		MappedFile file;
+		if (!stat_source(path, source) || !file.open(path) || file.size() == 0)
+		{
+			return false;
+		}
+		source.content_hash = fnv1a_64(file.data(), file.size());
+
+		if (!rasterize_font(file.data(), (int)file.size(), font, atlas))
+		{
+			return false;
+		}
+
+		if (!write_font(path, font, atlas, source))
+		{
+			debug_error("Failed to cache font: %s", path.c_str());
+		}
+
+		return true;
+	}
+
+	/**
+	 * LoadFontFromMemory() without the texture upload: glyphs are
+	 * rasterized and packed into `atlas` on the CPU, so this can
+	 * run on any thread. `font.texture` is left empty.
+	 */
+	bool AssetCache::rasterize_font(const unsigned char* data, int size, Font& font, Image& atlas)
+	{
+		PROFILE_SCOPE("AssetCache::rasterize_font");
+
+		font = {0};
+		atlas = {0};
+
+		// Same glyph set and padding as LoadFontFromMemory()
+		font.baseSize = _FONT_SIZE;
+		font.glyphCount = 95;
+		font.glyphs = LoadFontData(data, size, font.baseSize, NULL, font.glyphCount, FONT_DEFAULT);
+		if (font.glyphs == nullptr)
+		{
+			font = {0};
+			return false;
+		}
+
+		font.glyphPadding = 4;
+		atlas = GenImageFontAtlas(font.glyphs, &font.recs, font.glyphCount, font.baseSize, font.glyphPadding, 0);
+		if (atlas.data == nullptr || font.recs == nullptr)
+		{
+			UnloadFontData(font.glyphs, font.glyphCount);
+			MemFree(font.recs);
+			UnloadImage(atlas);
+			font = {0};
+			atlas = {0};
+			return false;
+		}
+
+		// Glyph images are cut from the atlas, as LoadFontFromMemory()
+		// does, for ImageDrawText()
+		for (int i = 0; i < font.glyphCount; i++)
+		{
+			UnloadImage(font.glyphs[i].image);
+			font.glyphs[i].image = ImageFromImage(atlas, font.recs[i]);
+		}
+
+		return true;
+	}
+
+	bool AssetCache::write_font(const std::string& path, const Font& font, const Image& atlas, const SourceInfo& source)
+	{
+		if (!is_bakeable_font(path) || font.glyphs == nullptr || font.recs == nullptr ||
+			font.glyphCount <= 0 || atlas.data == nullptr || atlas.mipmaps != 1)
+		{
+			return false;
+		}
+
+		if (atlas.format < PIXELFORMAT_UNCOMPRESSED_GRAYSCALE || atlas.format > PIXELFORMAT_UNCOMPRESSED_R8G8B8A8)
+		{
+			return false;
+		}
+
+		ByteStream header;
+		header << _FONT_MAGIC << _VERSION << source.mtime << source.size << source.content_hash;
+		header << (int32_t)font.baseSize << (int32_t)font.glyphCount << (int32_t)font.glyphPadding;
+		for (int i = 0; i < font.glyphCount; i++)
+		{
+			const GlyphInfo& glyph = font.glyphs[i];
+			const Rectangle& rec = font.recs[i];
+			header << (int32_t)glyph.value << (int32_t)glyph.offsetX << (int32_t)glyph.offsetY << (int32_t)glyph.advanceX;
+			header << rec.x << rec.y << rec.width << rec.height;
+		}
+
+		return write_entry(entry_path(path, ".bfnt"), header, atlas);
+	}
+
+	/**
+	 * Brings the cache up to date with every image (and optionally
+	 * font) under `directory`. Both are decoded on the job system.
+	 * Returns the number of assets imported.
+	 */
+	size_t AssetCache::import_directory(const std::string& directory, bool include_fonts)
+	{
+		namespace fs = std::filesystem;
+
+		PROFILE_SCOPE("AssetCache::import_directory");
+
+		std::vector<std::string> images;
+		std::vector<std::string> fonts;
+
+		std::error_code error;
+		for (auto it = fs::recursive_directory_iterator(directory, error);
+			 it != fs::recursive_directory_iterator(); it.increment(error))
+		{
+			if (error)
+			{
+				break;
+			}
+
+			// Skip generated folders such as .atlas and the cache itself
+			std::string name = it->path().filename().string();
+			if (it->is_directory())
+			{
+				if (!name.empty() && name[0] == '.')
+				{
+					it.disable_recursion_pending();
+				}
+				continue;
+			}
+
+			if (!it->is_regular_file())
+			{
+				continue;
+			}
+
+			std::string path = it->path().generic_string();
+			if (is_image_file(path) && !is_current(path, ".btex", _TEXTURE_MAGIC))
+			{
+				images.push_back(path);
+			}
+			else if (include_fonts && is_bakeable_font(path) && !is_current(path, ".bfnt", _FONT_MAGIC))
+			{
+				fonts.push_back(path);
+			}
+		}
+
+		typedef struct
+		{
+			AssetCache* cache;
+			const std::vector<std::string>* paths;
+			std::atomic<size_t> imported;
+		} ImportContext;
+
+		ImportContext context;
+		context.cache = this;
+		context.paths = &images;
+		context.imported = 0;
+
+		JobSystem::JobFunction import_images = [](int start, int end, uint32_t worker_index, void* data)
+		{
+			ImportContext* context = (ImportContext*)data;
+			for (int i = start; i < end; i++)
+			{
+				Image image = context->cache->decode_image((*context->paths)[i]);
+				if (image.data == nullptr)
+				{
+					debug_error("Failed to import image: %s", (*context->paths)[i].c_str());
+				}
+				else
+				{
+					context->imported++;
+				}
+				UnloadImage(image);
+			}
+		};
+
+		JobSystem::JobFunction import_fonts = [](int start, int end, uint32_t worker_index, void* data)
+		{
+			ImportContext* context = (ImportContext*)data;
+			for (int i = start; i < end; i++)
+			{
+				Font font;
+				Image atlas;
+				if (!context->cache->decode_font((*context->paths)[i], font, atlas))
+				{
+					debug_error("Failed to import font: %s", (*context->paths)[i].c_str());
+					continue;
+				}
+
+				context->imported++;
+				UnloadFontData(font.glyphs, font.glyphCount);
+				MemFree(font.recs);
+				UnloadImage(atlas);
+			}
+		};
+
+		if (globals::job_system != nullptr)
+		{
+			globals::job_system->wait(globals::job_system->dispatch(import_images, (int)images.size(), 1, &context));
+		}
+		else
+		{
+			import_images(0, (int)images.size(), 0, &context);
+		}
+
+		context.paths = &fonts;
+		if (globals::job_system != nullptr)
+		{
+			globals::job_system->wait(globals::job_system->dispatch(import_fonts, (int)fonts.size(), 1, &context));
+		}
+		else
+		{
+			import_fonts(0, (int)fonts.size(), 0, &context);
+		}
+
+		size_t imported = context.imported;
+		debug_log("Imported %zu of %zu assets into %s", imported, images.size() + fonts.size(),
+			m_cache_directory.c_str());
+		return imported;
+	}
+
+	void AssetCache::clear()
+	{
+		std::error_code error;
+		std::filesystem::remove_all(m_cache_directory, error);
+		if (error)
+		{
+			debug_error("Failed to clear asset cache %s", m_cache_directory.c_str());
+		}
+	}
+
+	/**
+	 * Fonts rasterized at load time, which are the ones worth baking.
+	 */
+	bool AssetCache::is_bakeable_font(const std::string& path)
+	{
+		return has_extension(path, {".ttf", ".otf"});
+	}
+
+	/**
+	 * Entries are named by a hash of the project-relative path, so
+	 * the cache survives the project being moved.
+	 */
+	std::string AssetCache::entry_path(const std::string& path, const char* extension) const
+	{
+		namespace fs = std::filesystem;
+
+		std::error_code error;
+		fs::path source = fs::weakly_canonical(path, error);
+		if (error)
+		{
+			source = path;
+		}
+
+		std::string key = source.generic_string();
+		fs::path relative = source.lexically_relative(m_project_directory);
+		if (!relative.empty() && *relative.begin() != "..")
+		{
+			key = relative.generic_string();
+		}
+
+		char name[32];
+		snprintf(name, sizeof(name), "%016llx", (unsigned long long)fnv1a_64(key));
+		return m_cache_directory + "/" + name + extension;
+	}
+
+	/**
+	 * Opens the entry for `path` and checks it against the source.
+	 * On success `body` is positioned after the common header.
+	 */
+	bool AssetCache::open_entry(const std::string& path, const std::string& entry, uint32_t magic,
+		std::shared_ptr<MappedFile>& file, ByteView& body)
+	{
+		SourceInfo source;
+		if (!stat_source(path, source))
+		{
+			return false;
+		}
+
+		file = std::make_shared<MappedFile>();
+		if (!file->open(entry))
+		{
+			return false;
+		}
+
+		ByteView bytes = file->view();
+		uint32_t entry_magic, version;
+		int64_t mtime;
+		uint64_t size, content_hash;
+		try
+		{
+			bytes >> entry_magic >> version >> mtime >> size >> content_hash;
+		}
+		catch (const std::out_of_range&)
+		{
+			return false;
+		}
+
+		if (entry_magic != magic || version != _VERSION || size != source.size)
+		{
+			return false;
+		}
+
+		// Touched but possibly unchanged, e.g. by a checkout
+		if (mtime != source.mtime)
+		{
+			uint64_t hash;
+			if (!hash_source(path, hash) || hash != content_hash)
+			{
+				return false;
+			}
+
+			// Store the new mtime so the next open skips the hash.
+			// The entry may be mapped or read by another thread, so
+			// it is replaced like write_entry() does, never patched.
+			// A failed replace only costs another hash next time.
+			ByteStream header;
+			header << entry_magic << version << source.mtime << size << content_hash;
+			const size_t header_size = header.size();
+			replace_entry(entry, header.raw().data(), header_size,
+				file->data() + header_size, file->size() - header_size);
+		}
+
+		body = bytes;
+		return true;
+	}
+
+	bool AssetCache::is_current(const std::string& path, const char* extension, uint32_t magic)
+	{
+		std::shared_ptr<MappedFile> file;
+		ByteView body;
+		if (!open_entry(path, entry_path(path, extension), magic, file, body))
+		{
+			return false;
+		}
+
+		if (magic != _TEXTURE_MAGIC)
+		{
+			return true;
+		}
+
+		Image image = {0};
+		try
+		{
+			return read_image_block(body, image) && accepts_mipmaps(image.mipmaps);
+		}
+		catch (const std::out_of_range&)
+		{
+			return false;
+		}
+	}
+
+	/**
+	 * Appends the image block to `header` and writes both out.
+	 * The entry is written aside and renamed into place, so
+	 * readers never map a partial file.
+	 */
+	bool AssetCache::write_entry(const std::string& entry, ByteStream& header, const Image& image)
+	{
+		namespace fs = std::filesystem;
+
+		size_t data_size = image_data_size(image.width, image.height, image.format, image.mipmaps);
+		header << (int32_t)image.width << (int32_t)image.height << (int32_t)image.format;
+		header << (int32_t)image.mipmaps << (uint64_t)data_size;
+
+		std::error_code error;
+		fs::create_directories(m_cache_directory, error);
+
+		return replace_entry(entry, header.raw().data(), header.size(), image.data, data_size);
+	}
+
+	/**
+	 * Writes `head` then `tail` to a per-thread temp file and renames
+	 * it over the entry, so readers see either the old entry or the
+	 * new one, never a partial write.
+	 */
+	bool AssetCache::replace_entry(const std::string& entry, const void* head, size_t head_size,
+		const void* tail, size_t tail_size)
+	{
+		namespace fs = std::filesystem;
+
+		std::error_code error;
+		std::string temp = entry + "." +
+			std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp";
+		{
+			std::ofstream outfile(temp, std::ios::binary | std::ios::trunc);
+			if (!outfile.is_open())
+			{
+				return false;
+			}
+
+			outfile.write((const char*)head, head_size);
+			outfile.write((const char*)tail, tail_size);
+			if (!outfile)
+			{
+				outfile.close();
+				fs::remove(temp, error);
+				return false;
+			}
+		}
+
+		fs::rename(temp, entry, error);
+		if (error)
+		{
+			fs::remove(temp, error);
+			return false;
+		}
+
+		m_writes++;
+		return true;
+	}
+
+	bool AssetCache::write_image(const std::string& path, const Image& image, const SourceInfo& source)
+	{
+		ByteStream header;
+		header << _TEXTURE_MAGIC << _VERSION << source.mtime << source.size << source.content_hash;
+		return write_entry(entry_path(path, ".btex"), header, image);
+	}
+} // namespace bacon
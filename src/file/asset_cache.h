@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "raylib.h"
+
+#include "file/mapped_file.h"
+
+namespace bacon
+{
+	class ByteStream;
+
+	/**
+	 * Pixels read back from the import cache.
+	 * image.data points into `file`: never unload it, and only use
+	 * it while `file` is held.
+	 */
+	typedef struct
+	{
+		std::shared_ptr<MappedFile> file;
+		Image image;
+	} CachedImage;
+
+	/**
+	 * Import cache for project assets.
+	 *
+	 * Images are stored as raw pixels in the format they are
+	 * uploaded in, optionally with mipmaps, and TTF/OTF fonts as
+	 * their baked glyph atlas and metrics, so loading one is a
+	 * single mapped read with no decoding or rasterizing.
+	 *
+	 * Entries live in `<project>/.bacon_cache`, named by a hash of
+	 * the project-relative path. An entry is current while the
+	 * source's size and mtime match; if only the mtime changed, the
+	 * source's content hash decides.
+	 *
+	 * Nothing here touches the GPU, so every function may be
+	 * called from any thread.
+	 */
+	class AssetCache
+	{
+	public:
+		static constexpr uint32_t _TEXTURE_MAGIC = 0x58455442; // "BTEX"
+		static constexpr uint32_t _FONT_MAGIC = 0x544E4642; // "BFNT"
+		static constexpr uint32_t _VERSION = 1;
+		static constexpr const char* _CACHE_DIR = ".bacon_cache";
+		// Size TTF/OTF fonts are rasterized at, same as LoadFont()
+		static constexpr int _FONT_SIZE = 32;
+
+		typedef struct
+		{
+			int64_t mtime;
+			uint64_t size;
+			uint64_t content_hash;
+		} SourceInfo;
+
+		explicit AssetCache(const std::string& project_directory, bool mipmaps = false);
+		AssetCache(const AssetCache& cache) = delete;
+		AssetCache& operator=(const AssetCache& cache) = delete;
+
+		bool read_image(const std::string& path, CachedImage& image);
+		bool read_font(const std::string& path, CachedImage& atlas, Font& font);
+		Image decode_image(const std::string& path);
+		bool decode_font(const std::string& path, Font& font, Image& atlas);
+
+		size_t import_directory(const std::string& directory, bool include_fonts);
+		void clear();
+
+		static bool is_bakeable_font(const std::string& path);
+		static bool rasterize_font(const unsigned char* data, int size, Font& font, Image& atlas);
+
+		const std::string& get_directory() const { return m_cache_directory; }
+		bool has_mipmaps() const { return m_mipmaps; }
+		uint64_t get_hits() const { return m_hits; }
+		uint64_t get_misses() const { return m_misses; }
+		uint64_t get_writes() const { return m_writes; }
+
+	private:
+		std::string m_project_directory;
+		std::string m_cache_directory;
+		bool m_mipmaps;
+
+		std::atomic<uint64_t> m_hits = 0;
+		std::atomic<uint64_t> m_misses = 0;
+		std::atomic<uint64_t> m_writes = 0;
+
+		std::string entry_path(const std::string& path, const char* extension) const;
+		bool open_entry(const std::string& path, const std::string& entry, uint32_t magic,
+			std::shared_ptr<MappedFile>& file, ByteView& body);
+		bool is_current(const std::string& path, const char* extension, uint32_t magic);
+		bool accepts_mipmaps(int mipmaps) const { return m_mipmaps || mipmaps == 1; }
+		bool write_entry(const std::string& entry, ByteStream& header, const Image& image);
+		bool replace_entry(const std::string& entry, const void* head, size_t head_size,
+			const void* tail, size_t tail_size);
+		bool write_image(const std::string& path, const Image& image, const SourceInfo& source);
+		bool write_font(const std::string& path, const Font& font, const Image& atlas, const SourceInfo& source);
+	};
+} // namespace bacon
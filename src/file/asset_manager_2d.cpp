@@ -1,56 +1,1003 @@
 #include "asset_manager_2d.h"
 
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
 #include <memory>
 
 #include "raylib.h"
 
+#include "core/2D/glyph_metrics.h"
+#include "core/profiler.h"
 #include "core/util.h"
+#include "lib/rect_packer.h"
 
 namespace bacon
 {
+	static constexpr uint32_t _ATLAS_CACHE_VERSION = 1;
+	static const char* _ATLAS_CACHE_DIR = ".atlas";
+	static const char* _ATLAS_CACHE_FILE = "atlas.json";
+
+	/**
+	 * Rasterizes a TTF/OTF file on the CPU when there is no import
+	 * cache to go through.
+	 */
+	static bool rasterize_font_file(const std::string& path, Font& font, Image& atlas)
+	{
+		int size = 0;
+		unsigned char* data = LoadFileData(path.c_str(), &size);
+		bool rasterized = data != nullptr && AssetCache::rasterize_font(data, size, font, atlas);
+		UnloadFileData(data);
+		return rasterized;
+	}
+
+	static std::string normalize_path(const std::string& path)
+	{
+		std::error_code error;
+		std::filesystem::path canonical = std::filesystem::weakly_canonical(path, error);
+		if (error)
+		{
+			return path;
+		}
+		return canonical.generic_string();
+	}
+
+	static bool is_image_file(const std::filesystem::path& path)
+	{
+		std::string extension = path.extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+		return extension == ".png" || extension == ".jpg" || extension == ".jpeg";
+	}
+
+	static size_t texture_bytes(const Texture2D& texture)
+	{
+		return (size_t)GetPixelDataSize(texture.width, texture.height, texture.format);
+	}
+
+	static size_t font_bytes(const Font& font)
+	{
+		size_t bytes = texture_bytes(font.texture);
+		bytes += (size_t)font.glyphCount * (sizeof(GlyphInfo) + sizeof(Rectangle));
+		if (font.glyphs != nullptr)
+		{
+			for (int i = 0; i < font.glyphCount; i++)
+			{
+				const Image& image = font.glyphs[i].image;
+				bytes += (size_t)GetPixelDataSize(image.width, image.height, image.format);
+			}
+		}
+		return bytes;
+	}
+
+	AssetManager2D::AssetManager2D(bool headless)
+	{
+		m_headless = headless;
+	}
+
 	AssetManager2D::~AssetManager2D()
 	{
+		stop_loaders();
 		this->cleanup();
 	}
 
 	std::shared_ptr<Texture2D> AssetManager2D::load_texture(const std::string& path)
 	{
+		if (m_headless)
+		{
+			return nullptr;
+		}
+
 		if (m_textures.find(path) != m_textures.end())
 		{
+			record_hit(m_texture_records, path);
 			return m_textures[path];
 		}
 		else
 		{
-			Texture2D new_texture = LoadTexture(path.c_str());
+			m_misses++;
+			Texture2D new_texture = load_texture_file(path);
 			if (new_texture.id <= 0)
 			{
 				debug_error("Failed to load texture: %s", path.c_str());
 				return nullptr;
 			}
 			m_textures[path] = std::make_shared<Texture2D>(new_texture);
+			record_load(m_texture_records, path, texture_bytes(new_texture));
 			return m_textures[path];
 		}
 	}
 
+	/**
+	 * Looks the image up in the sprite atlas first, falling back
+	 * to a standalone texture covering the whole image.
+	 */
+	TextureRegion AssetManager2D::load_texture_region(const std::string& path)
+	{
+		if (!m_atlas_entries.empty())
+		{
+			auto it = m_atlas_entries.find(normalize_path(path));
+			if (it != m_atlas_entries.end())
+			{
+				return {m_atlas_pages[it->second.page], it->second.source};
+			}
+		}
+
+		std::shared_ptr<Texture2D> texture = load_texture(path);
+		if (texture == nullptr)
+		{
+			return {nullptr, {0, 0, 0, 0}};
+		}
+
+		return {texture, {0, 0, (float)texture->width, (float)texture->height}};
+	}
+
+	/**
+	 * Packs every image under `directory` into atlas pages.
+	 * The layout and page images are cached in `<directory>/.atlas`
+	 * and only rebuilt when an image is added, removed or modified.
+	 */
+	bool AssetManager2D::build_sprite_atlas(const std::string& directory)
+	{
+		namespace fs = std::filesystem;
+		using json = nlohmann::json;
+
+		clear_sprite_atlas();
+		m_atlas_enabled = true;
+
+		if (m_headless)
+		{
+			return false;
+		}
+
+		std::error_code error;
+		if (!fs::is_directory(directory, error))
+		{
+			debug_error("Failed to build sprite atlas: %s is not a directory", directory.c_str());
+			return false;
+		}
+
+		// Gather sources, skipping the cache directory
+		std::vector<std::pair<std::string, int64_t>> files;
+		for (auto it = fs::recursive_directory_iterator(directory, error);
+			 it != fs::recursive_directory_iterator(); it.increment(error))
+		{
+			if (error)
+			{
+				break;
+			}
+
+			if (it->is_directory() && it->path().filename() == _ATLAS_CACHE_DIR)
+			{
+				it.disable_recursion_pending();
+				continue;
+			}
+
+			if (!it->is_regular_file() || !is_image_file(it->path()))
+			{
+				continue;
+			}
+
+			std::string relative = fs::relative(it->path(), directory).generic_string();
+			int64_t mtime = (int64_t)fs::last_write_time(it->path()).time_since_epoch().count();
+			files.push_back({relative, mtime});
+		}
+		std::sort(files.begin(), files.end());
+
+		json sources = json::array();
+		for (const auto& file : files)
+		{
+			sources.push_back({{"path", file.first}, {"mtime", file.second}});
+		}
+
+		if (load_atlas_cache(directory, sources))
+		{
+			debug_log("Loaded sprite atlas from cache (%zu pages)", m_atlas_pages.size());
+			return true;
+		}
+
+		clear_sprite_atlas();
+		m_atlas_enabled = true;
+		if (!pack_atlas(directory, sources))
+		{
+			clear_sprite_atlas();
+			m_atlas_enabled = true;
+			return false;
+		}
+
+		debug_log("Built sprite atlas (%zu pages)", m_atlas_pages.size());
+		return true;
+	}
+
+	bool AssetManager2D::load_atlas_cache(const std::string& directory, const nlohmann::json& sources)
+	{
+		namespace fs = std::filesystem;
+		using json = nlohmann::json;
+
+		fs::path cache_dir = fs::path(directory) / _ATLAS_CACHE_DIR;
+		std::ifstream infile(cache_dir / _ATLAS_CACHE_FILE);
+		if (!infile.is_open())
+		{
+			return false;
+		}
+
+		json cache = json::parse(infile, nullptr, false);
+		if (cache.is_discarded() ||
+			json_read_uint32(cache, "version") != _ATLAS_CACHE_VERSION ||
+			json_read_int32(cache, "page_size") != _ATLAS_PAGE_SIZE ||
+			!cache.contains("sources") || cache["sources"] != sources ||
+			!cache.contains("pages") || !cache.contains("entries"))
+		{
+			return false;
+		}
+
+		for (const json& page : cache["pages"])
+		{
+			std::string page_path = (cache_dir / page.get<std::string>()).generic_string();
+			Texture2D texture = load_texture_file(page_path);
+			if (texture.id <= 0)
+			{
+				return false;
+			}
+			m_atlas_pages.push_back(std::make_shared<Texture2D>(texture));
+		}
+
+		for (const json& entry : cache["entries"])
+		{
+			size_t page = json_read_size_t(entry, "page");
+			if (page >= m_atlas_pages.size())
+			{
+				return false;
+			}
+
+			std::string path = (fs::path(directory) / json_read_string(entry, "path")).generic_string();
+			m_atlas_entries[normalize_path(path)] = {
+				page,
+				{
+					json_read_float(entry, "x"),
+					json_read_float(entry, "y"),
+					json_read_float(entry, "w"),
+					json_read_float(entry, "h"),
+				},
+			};
+		}
+
+		return true;
+	}
+
+	bool AssetManager2D::pack_atlas(const std::string& directory, const nlohmann::json& sources)
+	{
+		namespace fs = std::filesystem;
+		using json = nlohmann::json;
+
+		typedef struct
+		{
+			std::string path;
+			Image image;
+		} SourceImage;
+
+		std::vector<SourceImage> images;
+		for (const json& source : sources)
+		{
+			std::string relative = json_read_string(source, "path");
+			std::string path = (fs::path(directory) / relative).generic_string();
+
+			Image image = LoadImage(path.c_str());
+			if (image.data == nullptr)
+			{
+				debug_error("Failed to load image for atlas: %s", path.c_str());
+				continue;
+			}
+
+			// Images that can't fit a page stay standalone textures
+			if (image.width + _ATLAS_PADDING * 2 > _ATLAS_PAGE_SIZE ||
+				image.height + _ATLAS_PADDING * 2 > _ATLAS_PAGE_SIZE)
+			{
+				UnloadImage(image);
+				continue;
+			}
+
+			ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+			images.push_back({relative, image});
+		}
+
+		// Tallest first packs the skyline tighter
+		std::sort(images.begin(), images.end(),
+			[](const SourceImage& a, const SourceImage& b)
+			{
+				if (a.image.height != b.image.height)
+				{
+					return a.image.height > b.image.height;
+				}
+				return a.path < b.path;
+			});
+
+		fs::path cache_dir = fs::path(directory) / _ATLAS_CACHE_DIR;
+		std::error_code error;
+		fs::create_directories(cache_dir, error);
+
+		json cache;
+		cache["version"] = _ATLAS_CACHE_VERSION;
+		cache["page_size"] = _ATLAS_PAGE_SIZE;
+		cache["sources"] = sources;
+		cache["pages"] = json::array();
+		cache["entries"] = json::array();
+
+		std::vector<Image> pages;
+		RectPacker packer(_ATLAS_PAGE_SIZE, _ATLAS_PAGE_SIZE);
+		for (const SourceImage& source : images)
+		{
+			int padded_width = source.image.width + _ATLAS_PADDING * 2;
+			int padded_height = source.image.height + _ATLAS_PADDING * 2;
+
+			int x, y;
+			if (pages.empty() || !packer.pack(padded_width, padded_height, &x, &y))
+			{
+				pages.push_back(GenImageColor(_ATLAS_PAGE_SIZE, _ATLAS_PAGE_SIZE, BLANK));
+				packer.reset(_ATLAS_PAGE_SIZE, _ATLAS_PAGE_SIZE);
+				packer.pack(padded_width, padded_height, &x, &y);
+			}
+			x += _ATLAS_PADDING;
+			y += _ATLAS_PADDING;
+
+			// Both images are RGBA8, so rows can be copied directly
+			Image& page = pages.back();
+			const size_t row_bytes = (size_t)source.image.width * 4;
+			for (int row = 0; row < source.image.height; row++)
+			{
+				unsigned char* dst = (unsigned char*)page.data + ((size_t)(y + row) * page.width + x) * 4;
+				const unsigned char* src = (const unsigned char*)source.image.data + (size_t)row * row_bytes;
+				memcpy(dst, src, row_bytes);
+			}
+
+			size_t page_index = pages.size() - 1;
+			std::string path = (fs::path(directory) / source.path).generic_string();
+			Rectangle rect = {(float)x, (float)y, (float)source.image.width, (float)source.image.height};
+			m_atlas_entries[normalize_path(path)] = {page_index, rect};
+
+			cache["entries"].push_back({
+				{"path", source.path},
+				{"page", page_index},
+				{"x", rect.x},
+				{"y", rect.y},
+				{"w", rect.width},
+				{"h", rect.height},
+			});
+		}
+
+		for (SourceImage& source : images)
+		{
+			UnloadImage(source.image);
+		}
+
+		bool cache_written = true;
+		for (size_t i = 0; i < pages.size(); i++)
+		{
+			std::string page_name = "page_" + std::to_string(i) + ".png";
+			std::string page_path = (cache_dir / page_name).generic_string();
+			if (!ExportImage(pages[i], page_path.c_str()))
+			{
+				cache_written = false;
+			}
+			cache["pages"].push_back(page_name);
+
+			Texture2D texture = LoadTextureFromImage(pages[i]);
+			UnloadImage(pages[i]);
+			if (texture.id <= 0)
+			{
+				debug_error("Failed to upload atlas page %zu", i);
+				for (size_t j = i + 1; j < pages.size(); j++)
+				{
+					UnloadImage(pages[j]);
+				}
+				return false;
+			}
+			m_atlas_pages.push_back(std::make_shared<Texture2D>(texture));
+		}
+
+		if (cache_written)
+		{
+			std::ofstream outfile(cache_dir / _ATLAS_CACHE_FILE);
+			outfile << std::setw(4) << cache;
+		}
+		else
+		{
+			debug_error("Failed to write sprite atlas cache to %s", cache_dir.generic_string().c_str());
+		}
+
+		return true;
+	}
+
+	void AssetManager2D::clear_sprite_atlas()
+	{
+		for (std::shared_ptr<Texture2D>& page : m_atlas_pages)
+		{
+			UnloadTexture(*page);
+		}
+		m_atlas_pages.clear();
+		m_atlas_entries.clear();
+		m_atlas_enabled = false;
+	}
+
 	std::shared_ptr<Font> AssetManager2D::load_font(const std::string& path)
 	{
+		if (m_headless)
+		{
+			return nullptr;
+		}
+
 		if (m_fonts.find(path) != m_fonts.end())
 		{
+			record_hit(m_font_records, path);
 			return m_fonts[path];
 		}
 		else
 		{
-			Font new_font = LoadFont(path.c_str());
+			m_misses++;
+			Font new_font = load_font_file(path);
 			if (new_font.baseSize <= 0)
 			{
 				debug_error("Failed to load font: %s", path.c_str());
 				return {0};
 			}
 			m_fonts[path] = std::make_shared<Font>(new_font);
+			record_load(m_font_records, path, font_bytes(new_font));
 			return m_fonts[path];
 		}
 	}
 
+	/**
+	 * Returns a texture handle straight away and decodes the image
+	 * on a loader thread. The handle shows a placeholder until
+	 * update() uploads the image into it. Requests for a path that
+	 * is already loading share the same handle.
+	 */
+	std::shared_ptr<Texture2D> AssetManager2D::load_texture_async(const std::string& path)
+	{
+		if (m_headless)
+		{
+			return nullptr;
+		}
+
+		auto it = m_textures.find(path);
+		if (it != m_textures.end())
+		{
+			record_hit(m_texture_records, path);
+			return it->second;
+		}
+
+		m_misses++;
+		record_load(m_texture_records, path, 0);
+		std::shared_ptr<Texture2D> texture = std::make_shared<Texture2D>(get_placeholder());
+		m_textures[path] = texture;
+		m_pending_textures.insert(path);
+		queue_load(false, path);
+
+		return texture;
+	}
+
+	/**
+	 * Atlas regions are ready immediately. Standalone textures load
+	 * asynchronously and get an empty source rect, meaning the
+	 * whole texture once it arrives.
+	 */
+	TextureRegion AssetManager2D::load_texture_region_async(const std::string& path)
+	{
+		if (!m_atlas_entries.empty())
+		{
+			auto it = m_atlas_entries.find(normalize_path(path));
+			if (it != m_atlas_entries.end())
+			{
+				return {m_atlas_pages[it->second.page], it->second.source};
+			}
+		}
+
+		return {load_texture_async(path), {0, 0, 0, 0}};
+	}
+
+	/**
+	 * Like load_texture_async(); the handle holds the default
+	 * font until the real one is ready.
+	 */
+	std::shared_ptr<Font> AssetManager2D::load_font_async(const std::string& path)
+	{
+		if (m_headless)
+		{
+			return nullptr;
+		}
+
+		auto it = m_fonts.find(path);
+		if (it != m_fonts.end())
+		{
+			record_hit(m_font_records, path);
+			return it->second;
+		}
+
+		m_misses++;
+		record_load(m_font_records, path, 0);
+		std::shared_ptr<Font> font = std::make_shared<Font>(GetFontDefault());
+		m_fonts[path] = font;
+		m_pending_fonts.insert(path);
+		queue_load(true, path);
+
+		return font;
+	}
+
+	/**
+	 * Uploads finished loads to the GPU until the budget runs out.
+	 * Call once per frame on the main thread.
+	 */
+	void AssetManager2D::update()
+	{
+		m_loaded_fonts.clear();
+		m_frame++;
+
+		trim();
+
+		if (m_pending_textures.empty() && m_pending_fonts.empty())
+		{
+			return;
+		}
+
+		PROFILE_SCOPE("AssetManager2D::update");
+
+		using clock = std::chrono::steady_clock;
+		clock::time_point start = clock::now();
+
+		while (true)
+		{
+			LoadRequest request;
+			{
+				std::lock_guard<std::mutex> lock(m_load_mutex);
+				if (m_load_results.empty())
+				{
+					break;
+				}
+				request = m_load_results.front();
+				m_load_results.pop_front();
+			}
+
+			if (request.is_font)
+			{
+				// Dropped by cleanup() while loading
+				if (m_pending_fonts.erase(request.path) == 0)
+				{
+					release_request(request);
+					continue;
+				}
+
+				Font font = {0};
+				if (request.font.glyphs != nullptr)
+				{
+					// Rasterized or read from the cache on the loader
+					// thread: only the atlas is left to upload
+					const Image& atlas = (request.cached.file != nullptr) ? request.cached.image : request.image;
+					font = request.font;
+					request.font = {0};
+					font.texture = LoadTextureFromImage(atlas);
+					if (font.texture.id == 0)
+					{
+						UnloadFontData(font.glyphs, font.glyphCount);
+						MemFree(font.recs);
+						font = {0};
+					}
+				}
+				else if (request.file_data != nullptr)
+				{
+					// Formats other than TTF/OTF
+					font = LoadFontFromMemory(GetFileExtension(request.path.c_str()),
+						request.file_data, request.file_size, AssetCache::_FONT_SIZE, NULL, 0);
+					if (font.texture.id == GetFontDefault().texture.id)
+					{
+						font = {0};
+					}
+				}
+				release_request(request);
+
+				if (font.baseSize <= 0 || font.texture.id == 0)
+				{
+					debug_error("Failed to load font: %s", request.path.c_str());
+					m_fonts.erase(request.path);
+					forget(m_font_records, request.path);
+					continue;
+				}
+
+				*m_fonts[request.path] = font;
+				record_load(m_font_records, request.path, font_bytes(font));
+				m_loaded_fonts.push_back(request.path);
+			}
+			else
+			{
+				if (m_pending_textures.erase(request.path) == 0)
+				{
+					release_request(request);
+					continue;
+				}
+
+				const Image& image = (request.cached.file != nullptr) ? request.cached.image : request.image;
+				if (image.data == nullptr)
+				{
+					debug_error("Failed to load texture: %s", request.path.c_str());
+					m_textures.erase(request.path);
+					forget(m_texture_records, request.path);
+					continue;
+				}
+
+				Texture2D texture = LoadTextureFromImage(image);
+				release_request(request);
+
+				if (texture.id == 0)
+				{
+					debug_error("Failed to load texture: %s", request.path.c_str());
+					m_textures.erase(request.path);
+					forget(m_texture_records, request.path);
+					continue;
+				}
+
+				*m_textures[request.path] = texture;
+				record_load(m_texture_records, request.path, texture_bytes(texture));
+			}
+
+			float elapsed_ms = std::chrono::duration<float, std::milli>(clock::now() - start).count();
+			if (elapsed_ms >= upload_budget_ms)
+			{
+				break;
+			}
+		}
+	}
+
+	/**
+	 * Unloads assets nobody but the cache holds, least recently
+	 * used first, until at most target_bytes are cached.
+	 * Returns the number of assets evicted.
+	 */
+	size_t AssetManager2D::evict_unused(size_t target_bytes)
+	{
+		typedef struct
+		{
+			uint64_t last_used;
+			bool is_font;
+			std::string path;
+		} Candidate;
+
+		std::vector<Candidate> candidates;
+		for (auto& [path, texture] : m_textures)
+		{
+			if (texture.use_count() == 1 && m_pending_textures.count(path) == 0)
+			{
+				candidates.push_back({m_texture_records[path].last_used, false, path});
+			}
+		}
+		for (auto& [path, font] : m_fonts)
+		{
+			if (font.use_count() == 1 && m_pending_fonts.count(path) == 0)
+			{
+				candidates.push_back({m_font_records[path].last_used, true, path});
+			}
+		}
+
+		std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b)
+			{
+				return a.last_used < b.last_used;
+			});
+
+		size_t evicted = 0;
+		for (const Candidate& candidate : candidates)
+		{
+			if (m_memory_used <= target_bytes)
+			{
+				break;
+			}
+
+			if (candidate.is_font)
+			{
+				GlyphMetrics::forget(*m_fonts[candidate.path]);
+				UnloadFont(*m_fonts[candidate.path]);
+				m_fonts.erase(candidate.path);
+				forget(m_font_records, candidate.path);
+			}
+			else
+			{
+				UnloadTexture(*m_textures[candidate.path]);
+				m_textures.erase(candidate.path);
+				forget(m_texture_records, candidate.path);
+			}
+			evicted++;
+		}
+
+		m_evictions += evicted;
+		return evicted;
+	}
+
+	std::vector<AssetInfo> AssetManager2D::get_asset_info() const
+	{
+		std::vector<AssetInfo> info;
+		info.reserve(m_textures.size() + m_fonts.size());
+
+		for (const auto& [path, texture] : m_textures)
+		{
+			const AssetRecord& record = m_texture_records.at(path);
+			info.push_back({path, false, record.bytes, record.hits, record.last_used,
+				texture.use_count() - 1, m_pending_textures.count(path) > 0});
+		}
+		for (const auto& [path, font] : m_fonts)
+		{
+			const AssetRecord& record = m_font_records.at(path);
+			info.push_back({path, true, record.bytes, record.hits, record.last_used,
+				font.use_count() - 1, m_pending_fonts.count(path) > 0});
+		}
+
+		return info;
+	}
+
+	void AssetManager2D::record_hit(RecordMap& records, const std::string& path)
+	{
+		AssetRecord& record = records[path];
+		record.hits++;
+		record.last_used = m_frame;
+		m_hits++;
+	}
+
+	void AssetManager2D::record_load(RecordMap& records, const std::string& path, size_t bytes)
+	{
+		AssetRecord& record = records[path];
+		m_memory_used = m_memory_used - record.bytes + bytes;
+		record.bytes = bytes;
+		record.last_used = m_frame;
+	}
+
+	void AssetManager2D::forget(RecordMap& records, const std::string& path)
+	{
+		auto it = records.find(path);
+		if (it != records.end())
+		{
+			m_memory_used -= it->second.bytes;
+			records.erase(it);
+		}
+	}
+
+	/**
+	 * Marks held assets as used this frame, then evicts if the
+	 * cache is over budget.
+	 */
+	void AssetManager2D::trim()
+	{
+		for (const auto& [path, texture] : m_textures)
+		{
+			if (texture.use_count() > 1)
+			{
+				m_texture_records[path].last_used = m_frame;
+			}
+		}
+		for (const auto& [path, font] : m_fonts)
+		{
+			if (font.use_count() > 1)
+			{
+				m_font_records[path].last_used = m_frame;
+			}
+		}
+
+		if (memory_budget > 0 && m_memory_used > memory_budget)
+		{
+			evict_unused(memory_budget);
+		}
+	}
+
+	/**
+	 * Blocking texture load through the import cache, if any.
+	 */
+	Texture2D AssetManager2D::load_texture_file(const std::string& path)
+	{
+		if (m_import_cache == nullptr)
+		{
+			return LoadTexture(path.c_str());
+		}
+
+		CachedImage cached;
+		if (m_import_cache->read_image(path, cached))
+		{
+			return LoadTextureFromImage(cached.image);
+		}
+
+		Texture2D texture = {0};
+		Image image = m_import_cache->decode_image(path);
+		if (image.data != nullptr)
+		{
+			texture = LoadTextureFromImage(image);
+			UnloadImage(image);
+		}
+		return texture;
+	}
+
+	/**
+	 * Blocking font load through the import cache, if any.
+	 * TTF/OTF fonts are baked into the cache on first load.
+	 */
+	Font AssetManager2D::load_font_file(const std::string& path)
+	{
+		if (!AssetCache::is_bakeable_font(path))
+		{
+			return LoadFont(path.c_str());
+		}
+
+		Font font = {0};
+		CachedImage cached;
+		if (m_import_cache != nullptr && m_import_cache->read_font(path, cached, font))
+		{
+			font.texture = LoadTextureFromImage(cached.image);
+			return font;
+		}
+
+		Image atlas = {0};
+		bool decoded = (m_import_cache != nullptr)
+			? m_import_cache->decode_font(path, font, atlas)
+			: rasterize_font_file(path, font, atlas);
+		if (!decoded)
+		{
+			return {0};
+		}
+
+		font.texture = LoadTextureFromImage(atlas);
+		UnloadImage(atlas);
+		if (font.texture.id == 0)
+		{
+			UnloadFontData(font.glyphs, font.glyphCount);
+			MemFree(font.recs);
+			return {0};
+		}
+		return font;
+	}
+
+	bool AssetManager2D::is_pending(const std::string& path) const
+	{
+		return m_pending_textures.count(path) > 0 || m_pending_fonts.count(path) > 0;
+	}
+
+	void AssetManager2D::queue_load(bool is_font, const std::string& path)
+	{
+		std::lock_guard<std::mutex> lock(m_load_mutex);
+
+		// Threads start on first use so headless and tool runs
+		// that never load asynchronously don't pay for them
+		if (m_load_threads.empty())
+		{
+			m_load_stop = false;
+			for (uint32_t i = 0; i < _LOADER_THREADS; i++)
+			{
+				m_load_threads.emplace_back(&AssetManager2D::load_worker, this);
+			}
+		}
+
+		LoadRequest request = {};
+		request.is_font = is_font;
+		request.path = path;
+		request.cache = m_import_cache;
+		m_load_queue.push_back(request);
+		m_load_wake.notify_one();
+	}
+
+	/**
+	 * Does the file reading, image decoding and font rasterizing,
+	 * which don't need the GPU. update() only uploads the results.
+	 */
+	void AssetManager2D::load_worker()
+	{
+		profiler::set_thread_name("Asset Loader");
+
+		while (true)
+		{
+			LoadRequest request;
+			{
+				std::unique_lock<std::mutex> lock(m_load_mutex);
+				m_load_wake.wait(lock, [this]()
+					{
+						return m_load_stop || !m_load_queue.empty();
+					});
+
+				if (m_load_stop)
+				{
+					return;
+				}
+
+				request = m_load_queue.front();
+				m_load_queue.pop_front();
+			}
+
+			{
+				PROFILE_SCOPE("AssetManager2D::decode");
+				if (request.is_font)
+				{
+					if (!AssetCache::is_bakeable_font(request.path))
+					{
+						request.file_data = LoadFileData(request.path.c_str(), &request.file_size);
+					}
+					else if (request.cache == nullptr)
+					{
+						rasterize_font_file(request.path, request.font, request.image);
+					}
+					else if (!request.cache->read_font(request.path, request.cached, request.font))
+					{
+						request.cache->decode_font(request.path, request.font, request.image);
+					}
+				}
+				else if (request.cache != nullptr)
+				{
+					if (!request.cache->read_image(request.path, request.cached))
+					{
+						request.image = request.cache->decode_image(request.path);
+					}
+				}
+				else
+				{
+					request.image = LoadImage(request.path.c_str());
+				}
+			}
+
+			std::lock_guard<std::mutex> lock(m_load_mutex);
+			m_load_results.push_back(request);
+		}
+	}
+
+	void AssetManager2D::stop_loaders()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_load_mutex);
+			m_load_stop = true;
+		}
+		m_load_wake.notify_all();
+
+		for (std::thread& thread : m_load_threads)
+		{
+			thread.join();
+		}
+		m_load_threads.clear();
+
+		m_load_queue.clear();
+		for (LoadRequest& request : m_load_results)
+		{
+			release_request(request);
+		}
+		m_load_results.clear();
+	}
+
+	/**
+	 * Frees whatever a finished request still owns. Cached pixels
+	 * belong to the mapped file and are released with it.
+	 */
+	void AssetManager2D::release_request(LoadRequest& request)
+	{
+		UnloadImage(request.image);
+		request.image = {0};
+		UnloadFileData(request.file_data);
+		request.file_data = nullptr;
+		request.cached = {};
+
+		if (request.font.glyphs != nullptr)
+		{
+			UnloadFontData(request.font.glyphs, request.font.glyphCount);
+			MemFree(request.font.recs);
+			request.font = {0};
+		}
+	}
+
+	/**
+	 * Magenta/black checker shown while a texture is loading.
+	 */
+	const Texture2D& AssetManager2D::get_placeholder()
+	{
+		if (m_placeholder.id == 0)
+		{
+			Image image = GenImageChecked(8, 8, 4, 4, MAGENTA, BLACK);
+			m_placeholder = LoadTextureFromImage(image);
+			UnloadImage(image);
+		}
+
+		return m_placeholder;
+	}
+
 	const std::unordered_map<std::string, std::shared_ptr<Texture2D>>&
 	AssetManager2D::get_textures() const
 	{
@@ -65,20 +1012,41 @@ namespace bacon
 
 	void AssetManager2D::cleanup()
 	{
-		// Unload textures
+		// Unload textures. Pending ones still hold the placeholder.
 		for (auto it = m_textures.begin(); it != m_textures.end(); it++)
 		{
-			std::shared_ptr<Texture2D> texture = it->second;
-			UnloadTexture(*texture);
+			if (m_pending_textures.count(it->first) == 0)
+			{
+				std::shared_ptr<Texture2D> texture = it->second;
+				UnloadTexture(*texture);
+			}
 		}
 		m_textures.clear();
+		m_pending_textures.clear();
+
+		if (m_placeholder.id != 0)
+		{
+			UnloadTexture(m_placeholder);
+			m_placeholder = {0};
+		}
 
-		// Unload fonts
+		// Unload fonts. Pending ones still hold the default font.
 		for (auto it = m_fonts.begin(); it != m_fonts.end(); it++)
 		{
-			std::shared_ptr<Font> font = it->second;
-			UnloadFont(*font);
+			if (m_pending_fonts.count(it->first) == 0)
+			{
+				std::shared_ptr<Font> font = it->second;
+				GlyphMetrics::forget(*font);
+				UnloadFont(*font);
+			}
 		}
 		m_fonts.clear();
+		m_pending_fonts.clear();
+
+		m_texture_records.clear();
+		m_font_records.clear();
+		m_memory_used = 0;
+
+		clear_sprite_atlas();
 	}
 } // namespace bacon
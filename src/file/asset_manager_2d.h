@@ -1,12 +1,20 @@
 #pragma once
 
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#include "nlohmann/json.hpp"
 #include "raylib.h"
 
+#include "file/asset_cache.h"
+
 namespace bacon
 {
 	/*
@@ -15,21 +23,159 @@ namespace bacon
 	 * We use shared_ptr instead of copying to prevent undefined behavior.
 	 */
 
+	/**
+	 * A texture plus the part of it an image occupies.
+	 * Standalone textures use the full texture as their source.
+	 */
+	typedef struct
+	{
+		std::shared_ptr<Texture2D> texture;
+		Rectangle source;
+	} TextureRegion;
+
+	// One cached texture or font, for the asset inspector
+	typedef struct
+	{
+		std::string path;
+		bool is_font;
+		size_t bytes;
+		uint32_t hits;
+		uint64_t last_used;
+		// Holders other than the cache itself
+		long users;
+		bool pending;
+	} AssetInfo;
+
 	class AssetManager2D
 	{
 	public:
-		AssetManager2D() = default;
+		static constexpr int _ATLAS_PAGE_SIZE = 2048;
+		static constexpr int _ATLAS_PADDING = 1;
+		static constexpr uint32_t _LOADER_THREADS = 2;
+
+		// Main thread time spent on GPU uploads per update()
+		float upload_budget_ms = 2.f;
+		// Unused assets are evicted, least recently used first, while
+		// the cache is over this many bytes. 0 disables eviction.
+		size_t memory_budget = 256 * 1024 * 1024;
+
+		AssetManager2D(bool headless = false);
 		~AssetManager2D();
 
 		std::shared_ptr<Texture2D> load_texture(const std::string& path);
+		TextureRegion load_texture_region(const std::string& path);
 		std::shared_ptr<Font> load_font(const std::string& path);
+		std::shared_ptr<Texture2D> load_texture_async(const std::string& path);
+		TextureRegion load_texture_region_async(const std::string& path);
+		std::shared_ptr<Font> load_font_async(const std::string& path);
+		void update();
+		bool is_pending(const std::string& path) const;
+		size_t get_pending_count() const { return m_pending_textures.size() + m_pending_fonts.size(); }
+		// Fonts that finished loading during the last update()
+		const std::vector<std::string>& get_loaded_fonts() const { return m_loaded_fonts; }
+		size_t evict_unused(size_t target_bytes = 0);
+		std::vector<AssetInfo> get_asset_info() const;
+		size_t get_memory_used() const { return m_memory_used; }
+		uint64_t get_hits() const { return m_hits; }
+		uint64_t get_misses() const { return m_misses; }
+		uint64_t get_evictions() const { return m_evictions; }
+		uint64_t get_frame() const { return m_frame; }
+		void set_import_cache(std::shared_ptr<AssetCache> cache) { m_import_cache = cache; }
+		const std::shared_ptr<AssetCache>& get_import_cache() const { return m_import_cache; }
 		const std::unordered_map<std::string, std::shared_ptr<Texture2D>>& get_textures() const;
 		const std::unordered_map<std::string, std::shared_ptr<Font>>& get_fonts() const;
 
+		bool build_sprite_atlas(const std::string& directory);
+		void clear_sprite_atlas();
+		bool is_sprite_atlas_enabled() const { return m_atlas_enabled; }
+		bool is_headless() const { return m_headless; }
+		size_t get_atlas_page_count() const { return m_atlas_pages.size(); }
+
 		void cleanup();
 
 	private:
+		typedef struct
+		{
+			size_t page;
+			Rectangle source;
+		} AtlasEntry;
+
 		std::unordered_map<std::string, std::shared_ptr<Texture2D>> m_textures;
 		std::unordered_map<std::string, std::shared_ptr<Font>> m_fonts;
+
+		typedef struct
+		{
+			size_t bytes;
+			uint32_t hits;
+			// Frame the asset was last requested or held
+			uint64_t last_used;
+		} AssetRecord;
+		typedef std::unordered_map<std::string, AssetRecord> RecordMap;
+
+		RecordMap m_texture_records;
+		RecordMap m_font_records;
+		size_t m_memory_used = 0;
+		uint64_t m_frame = 0;
+		uint64_t m_hits = 0;
+		uint64_t m_misses = 0;
+		uint64_t m_evictions = 0;
+
+		// Decoded copies of project assets, null to always decode
+		std::shared_ptr<AssetCache> m_import_cache;
+
+		// No GPU context: loads return nullptr instead of uploading
+		bool m_headless;
+		bool m_atlas_enabled = false;
+		std::vector<std::shared_ptr<Texture2D>> m_atlas_pages;
+		// Keyed on the canonical image path
+		std::unordered_map<std::string, AtlasEntry> m_atlas_entries;
+
+		// File work done on a loader thread, finished on the main thread
+		typedef struct
+		{
+			bool is_font;
+			std::string path;
+			std::shared_ptr<AssetCache> cache;
+			// Decoded pixels, or the atlas of a freshly rasterized font
+			Image image;
+			// Raw file for fonts raylib can only load from memory
+			unsigned char* file_data;
+			int file_size;
+			// Read from the import cache: pixels (or a font's atlas)
+			// in `cached`
+			CachedImage cached;
+			// TTF/OTF fonts: everything but the texture
+			Font font;
+		} LoadRequest;
+
+		std::vector<std::thread> m_load_threads;
+		std::mutex m_load_mutex;
+		std::condition_variable m_load_wake;
+		std::deque<LoadRequest> m_load_queue;
+		std::deque<LoadRequest> m_load_results;
+		bool m_load_stop = false;
+
+		// Main thread only. Pending handles hold a placeholder
+		// until their upload replaces it in place.
+		std::unordered_set<std::string> m_pending_textures;
+		std::unordered_set<std::string> m_pending_fonts;
+		std::vector<std::string> m_loaded_fonts;
+		Texture2D m_placeholder = {0};
+
+		void record_hit(RecordMap& records, const std::string& path);
+		void record_load(RecordMap& records, const std::string& path, size_t bytes);
+		void forget(RecordMap& records, const std::string& path);
+		void trim();
+
+		Texture2D load_texture_file(const std::string& path);
+		Font load_font_file(const std::string& path);
+		void release_request(LoadRequest& request);
+		void queue_load(bool is_font, const std::string& path);
+		void load_worker();
+		void stop_loaders();
+		const Texture2D& get_placeholder();
+
+		bool load_atlas_cache(const std::string& directory, const nlohmann::json& sources);
+		bool pack_atlas(const std::string& directory, const nlohmann::json& sources);
 	};
 } // namespace bacon
@@ -1,7 +1,9 @@
 #include "file.h"
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
+#include <unordered_map>
 
 #include "core/2D/game_state_2d.h"
 #include "core/game_state.h"
@@ -9,7 +11,12 @@
 #include "nlohmann/json.hpp"
 #include "nfd.h"
 
+#include "core/2D/camera_object.h"
 #include "core/2D/entity_2d.h"
+#include "core/2D/text_object.h"
+#include "file/mapped_file.h"
+#include "file/project_loader.h"
+#include "lib/byte_stream.h"
 #include "editor/ui/editor_ui.h"
 #include "core/globals.h"
 #include "core/util.h"
@@ -18,12 +25,176 @@ namespace bacon
 {
 	namespace file
 	{
-		nfdresult_t save_project()
+		/**
+		 * Assigns each distinct header string (version, title,
+		 * asset paths) an index so the header stores it once.
+		 */
+		typedef struct
+		{
+			std::vector<std::string> strings;
+			std::unordered_map<std::string, uint32_t> lookup;
+
+			uint32_t intern(const std::string& string)
+			{
+				auto it = lookup.find(string);
+				if (it != lookup.end())
+				{
+					return it->second;
+				}
+
+				uint32_t index = (uint32_t)strings.size();
+				strings.push_back(string);
+				lookup[string] = index;
+				return index;
+			}
+		} StringTable;
+
+		typedef struct
+		{
+			AssetType type;
+			uint32_t path;
+		} AssetRef;
+
+		bool is_binary_project(const std::string& path)
+		{
+			return std::filesystem::path(path).extension() == ".bproj";
+		}
+
+		static void collect_assets(const GameObject* object, StringTable& strings,
+			std::vector<AssetRef>& assets)
+		{
+			if (const Entity2D* entity = dynamic_cast_to<const Entity2D>(object))
+			{
+				if (!entity->get_texture_path().empty())
+				{
+					assets.push_back({AssetType::TEXTURE, strings.intern(entity->get_texture_path())});
+				}
+			}
+			else if (const TextObject* text = dynamic_cast_to<const TextObject>(object))
+			{
+				if (!text->get_font_path().empty())
+				{
+					assets.push_back({AssetType::FONT, strings.intern(text->get_font_path())});
+				}
+			}
+
+			for (const GameObject* child : object->get_children())
+			{
+				collect_assets(child, strings, assets);
+			}
+		}
+
+		/**
+		 * Layout of a .bproj file. Everything goes through ByteStream,
+		 * so values are little-endian, floats are IEEE 754, bools are
+		 * one byte and strings are a uint64 length and their bytes.
+		 *   uint32 magic, uint32 version
+		 *   uint32 string count, strings
+		 *   uint32 version string, uint32 title string
+		 *   uint8 game type, float gravity, bool sprite atlas
+		 *   uint32 texture sorted layers (version 2+)
+		 *   bool fixed timestep, float physics rate, int32 max substeps (version 3+)
+		 *   uint32 asset count, (uint32 type, uint32 path string) per asset
+		 *   uint64 root object count, (uint64 length, serialize_to() bytes) per object
+		 *
+		 * The string table only holds header strings; object names,
+		 * tags and paths are written inline by serialize_to(). The
+		 * asset list lets the loader resolve every texture and font
+		 * before any object is constructed.
+		 */
+		static bool write_binary_project(const std::string& path)
+		{
+			StringTable strings;
+			std::vector<AssetRef> assets;
+			std::vector<const Object2D*> roots;
+
+			uint32_t version_index = strings.intern(globals::engine_version);
+			uint32_t title_index = strings.intern(globals::project_title);
+
+			float gravity = 0.f;
+			bool sprite_atlas = false;
+			bool fixed_timestep = true;
+			float physics_rate = 60.f;
+			int32_t max_substeps = 8;
+			if (GameState::game_type == GameState::GameType::GAME_2D)
+			{
+				Scene2D* scene = GameState::state_2d->scene;
+				gravity = scene->get_gravity();
+				fixed_timestep = scene->fixed_timestep;
+				physics_rate = scene->physics_rate;
+				max_substeps = scene->max_substeps;
+				sprite_atlas = GameState::state_2d->assets->is_sprite_atlas_enabled();
+
+				for (const Object2D* object : GameState::state_2d->scene->get_objects())
+				{
+					if (object->get_parent() == nullptr)
+					{
+						roots.push_back(object);
+						collect_assets(object, strings, assets);
+					}
+				}
+
+				// Objects sharing a texture only need it listed once
+				std::sort(assets.begin(), assets.end(), [](const AssetRef& a, const AssetRef& b)
+					{
+						return (a.type != b.type) ? a.type < b.type : a.path < b.path;
+					});
+				assets.erase(std::unique(assets.begin(), assets.end(), [](const AssetRef& a, const AssetRef& b)
+					{
+						return a.type == b.type && a.path == b.path;
+					}), assets.end());
+			}
+
+			ByteStream bytes;
+			bytes << bproj_magic << bproj_version;
+
+			bytes << (uint32_t)strings.strings.size();
+			for (const std::string& string : strings.strings)
+			{
+				bytes << string;
+			}
+
+			bytes << version_index << title_index;
+			bytes << (uint8_t)GameState::game_type << gravity << sprite_atlas;
+			bytes << globals::texture_sorted_layers;
+			bytes << fixed_timestep << physics_rate << max_substeps;
+
+			bytes << (uint32_t)assets.size();
+			for (const AssetRef& asset : assets)
+			{
+				bytes << (uint32_t)asset.type << asset.path;
+			}
+
+			bytes << (uint64_t)roots.size();
+			for (const Object2D* object : roots)
+			{
+				size_t length_position = bytes.begin_length_prefix();
+				object->serialize_to(bytes);
+				bytes.end_length_prefix(length_position);
+			}
+
+			std::ofstream outfile(path, std::ios::binary);
+			if (!outfile.is_open())
+			{
+				debug_error("Failed to write project: %s", path.c_str());
+				return false;
+			}
+			outfile.write((const char*)bytes.raw().data(), bytes.size());
+
+			return outfile.good();
+		}
+
+		static bool write_json_project(const std::string& path)
 		{
-			namespace fs = std::filesystem;
 			using json = nlohmann::json;
 
-			std::ofstream outfile(globals::project_file);
+			std::ofstream outfile(path);
+			if (!outfile.is_open())
+			{
+				debug_error("Failed to write project: %s", path.c_str());
+				return false;
+			}
+
 			json project_data;
 
 			project_data["settings"]["version"] = globals::engine_version;
@@ -33,6 +204,12 @@ namespace bacon
 			{
 				project_data["settings"]["game_type"] = GameState::GameType::GAME_2D;
 				project_data["settings"]["gravity"] = GameState::state_2d->scene->get_gravity();
+				project_data["settings"]["fixed_timestep"] = GameState::state_2d->scene->fixed_timestep;
+				project_data["settings"]["physics_rate"] = GameState::state_2d->scene->physics_rate;
+				project_data["settings"]["max_substeps"] = GameState::state_2d->scene->max_substeps;
+				project_data["settings"]["sprite_atlas"] =
+					GameState::state_2d->assets->is_sprite_atlas_enabled();
+				project_data["settings"]["texture_sorted_layers"] = globals::texture_sorted_layers;
 
 				const std::vector<Object2D*>& objects = GameState::state_2d->scene->get_objects();
 				for (Object2D* object : objects)
@@ -52,6 +229,36 @@ namespace bacon
 
 			outfile << std::setw(4) << project_data;
 
+			return outfile.good();
+		}
+
+		/**
+		 * Writes the current project to path, picking the format
+		 * from the extension. The open project file is unchanged.
+		 */
+		bool export_project(const std::string& path)
+		{
+			if (is_binary_project(path))
+			{
+				return write_binary_project(path);
+			}
+
+			return write_json_project(path);
+		}
+
+		nfdresult_t save_project()
+		{
+			if (globals::project_loader != nullptr && globals::project_loader->is_loading())
+			{
+				debug_error("Can't save while the project is still loading.");
+				return NFD_ERROR;
+			}
+
+			if (!export_project(globals::project_file))
+			{
+				return NFD_ERROR;
+			}
+
 			globals::has_unsaved_changes = false;
 			globals::update_window_title();
 
@@ -60,81 +267,264 @@ namespace bacon
 			return NFD_OKAY;
 		}
 
-		void parse_project_settings(const nlohmann::json& json)
+		/**
+		 * Loads source and writes it back out as destination,
+		 * e.g. game.json -> game.bproj.
+		 */
+		bool convert_project(const std::string& source, const std::string& destination)
+		{
+			globals::project_file = source;
+			if (load_project(false) != NFD_OKAY)
+			{
+				return false;
+			}
+
+			if (!export_project(destination))
+			{
+				return false;
+			}
+
+			debug_log("Converted %s to %s", source.c_str(), destination.c_str());
+			return true;
+		}
+
+		void read_json_header(const nlohmann::json& settings, ProjectHeader& header)
 		{
-			globals::engine_version = json_read_string(json, "version");
-			globals::project_title = json_read_string(json, "title");
-			GameState::state_2d->scene->set_gravity(json_read_float(json, "gravity"));
+			header.game_type = json_read_uint8(settings, "game_type");
+			header.sprite_atlas = json_read_bool(settings, "sprite_atlas");
+			header.version = json_read_string(settings, "version");
+			header.title = json_read_string(settings, "title");
+			header.gravity = json_read_float(settings, "gravity");
+			header.texture_sorted_layers = json_read_uint32(settings, "texture_sorted_layers");
+
+			// Projects saved before these existed keep the defaults
+			header.fixed_timestep = settings.contains("fixed_timestep") ?
+				json_read_bool(settings, "fixed_timestep") : true;
+			header.physics_rate = settings.contains("physics_rate") ?
+				json_read_float(settings, "physics_rate") : 60.f;
+			header.max_substeps = settings.contains("max_substeps") ?
+				json_read_int32(settings, "max_substeps") : 8;
+
+			header.assets.clear();
 		}
 
-		void parse_project_objects(const nlohmann::json& json)
+		/**
+		 * Reads a .bproj header up to the object count.
+		 * Returns false if the file isn't a .bproj this build can
+		 * read; throws std::out_of_range if it is truncated.
+		 */
+		bool read_binary_header(ByteView& bytes, ProjectHeader& header)
 		{
-			for (auto& object : json)
+			uint32_t magic = read_uint32(bytes);
+			uint32_t version = read_uint32(bytes);
+			if (magic != bproj_magic)
 			{
-				if (object.is_null())
-				{
-					debug_log("Null object encountered.");
-					continue;
-				}
+				debug_error("Failed to load project: not a .bproj file.");
+				return false;
+			}
+			if (version > bproj_version)
+			{
+				debug_error("Failed to load project: format version %u is newer than %u.",
+					version, bproj_version);
+				return false;
+			}
 
-				TypeID type_id = TypeID(json_read_uint32(object, "type_id"));
+			// Counts are checked against the file size before
+			// allocating so a corrupt header can't request gigabytes
+			uint32_t string_count = read_uint32(bytes);
+			if (string_count > bytes.remaining())
+			{
+				throw std::out_of_range("string count");
+			}
+			std::vector<std::string> strings(string_count);
+			for (std::string& string : strings)
+			{
+				bytes >> string;
+			}
 
-				if (type_id == TypeID::ENTITY_2D)
-				{
-					Entity2D* entity = new Entity2D();
-					entity->load_from_json(object);
-					entity->add_to_scene();
-				}
-				else if (type_id == TypeID::TEXT_2D)
-				{
-					TextObject* text = new TextObject();
-					text->load_from_json(object);
-					text->add_to_scene();
-				}
-				else if (type_id == TypeID::CAMERA_2D)
-				{
-					CameraObject* camera = new CameraObject();
-					camera->load_from_json(object);
-					camera->add_to_scene();
-				}
+			header.version = strings.at(read_uint32(bytes));
+			header.title = strings.at(read_uint32(bytes));
+			header.game_type = read_uint8(bytes);
+			header.gravity = read_float(bytes);
+			header.sprite_atlas = read_bool(bytes);
+			header.texture_sorted_layers = (version >= 2) ? read_uint32(bytes) : 0;
+			header.fixed_timestep = true;
+			header.physics_rate = 60.f;
+			header.max_substeps = 8;
+			if (version >= 3)
+			{
+				header.fixed_timestep = read_bool(bytes);
+				header.physics_rate = read_float(bytes);
+				header.max_substeps = read_int32(bytes);
 			}
+
+			uint32_t asset_count = read_uint32(bytes);
+			if (asset_count > bytes.remaining())
+			{
+				throw std::out_of_range("asset count");
+			}
+			header.assets.resize(asset_count);
+			for (asset_t& asset : header.assets)
+			{
+				asset.type = (AssetType)read_uint32(bytes);
+				asset.path = strings.at(read_uint32(bytes));
+			}
+
+			return true;
 		}
 
-		nfdresult_t load_project(bool show_dialog)
+		/**
+		 * Builds an object from its project JSON.
+		 * The caller adds it to the scene.
+		 */
+		GameObject* create_object_from_json(const nlohmann::json& data)
+		{
+			if (data.is_null())
+			{
+				debug_log("Null object encountered.");
+				return nullptr;
+			}
+
+			GameObject* object = nullptr;
+			TypeID type_id = TypeID(json_read_uint32(data, "type_id"));
+			if (type_id == TypeID::ENTITY_2D)
+			{
+				object = new Entity2D();
+			}
+			else if (type_id == TypeID::TEXT_2D)
+			{
+				object = new TextObject();
+			}
+			else if (type_id == TypeID::CAMERA_2D)
+			{
+				object = new CameraObject();
+			}
+			else
+			{
+				return nullptr;
+			}
+
+			object->load_from_json(data);
+			return object;
+		}
+
+		/**
+		 * Points the globals at the new project, clears or creates
+		 * the scene and applies the header settings, ready for
+		 * objects to be added.
+		 */
+		nfdresult_t begin_project_load(const std::string& file_path, const ProjectHeader& header)
 		{
 			namespace fs = std::filesystem;
-			using json = nlohmann::json;
 
-			debug_log("Loading project...");
-			std::string file_path = globals::project_file;
+			// Save path globals
+			fs::path entry_path = fs::path(file_path);
+			globals::project_file = file_path;
+			globals::project_directory =
+				entry_path.parent_path().generic_string();
+			globals::is_project_loaded = true;
 
-			if (show_dialog)
+			// Get project type
+			GameState::game_type = GameState::GameType::NONE;
+			switch ((GameState::GameType)header.game_type)
 			{
-				nfdu8char_t* path = NULL;
-				nfdu8filteritem_t filters[1] = {{"Project File", "json"}};
-				nfdopendialogu8args_t args = {0};
-				args.filterCount = 1;
-				args.filterList = filters;
-				nfdresult_t result = NFD_OpenDialogU8_With(&path, &args);
+				case GameState::GameType::NONE:
+				{
+					debug_error("Failed to load project: Invalid project type.");
+					return NFD_ERROR;
+				}
 
-				if (result == NFD_ERROR)
+				default:
 				{
-					free(path);
-					debug_error("Failed to load project.");
-					return result;
+					GameState::game_type = GameState::GameType(header.game_type);
+					break;
 				}
-				else if (result == NFD_CANCEL)
+			}
+
+			globals::engine_version = header.version;
+			globals::project_title = header.title;
+			globals::texture_sorted_layers = header.texture_sorted_layers;
+
+			if (GameState::game_type != GameState::GameType::GAME_2D)
+			{
+				return NFD_OKAY;
+			}
+
+			// Delete scene data
+			if (GameState::state_2d != nullptr && GameState::state_2d->scene != nullptr)
+			{
+				GameState::state_2d->scene->reset();
+			}
+			else
+			{
+				// Create state if it doesn't exist
+				if (!GameState::state_2d)
 				{
-					free(path);
-					return result;
+					GameState::state_2d = new GameState2D();
+				}
+			}
+
+			Scene2D* scene = GameState::state_2d->scene;
+			scene->set_gravity(header.gravity);
+			scene->fixed_timestep = header.fixed_timestep;
+			// Bad values would stall or skip the simulation
+			scene->physics_rate = (header.physics_rate > 0.f) ? header.physics_rate : 60.f;
+			scene->max_substeps = std::max(header.max_substeps, 1);
+
+			// The atlas must exist before objects resolve their textures
+			AssetManager2D* assets = GameState::state_2d->assets;
+			assets->set_import_cache(std::make_shared<AssetCache>(globals::project_directory));
+			if (header.sprite_atlas)
+			{
+				assets->build_sprite_atlas(globals::project_directory + "/sprites");
+			}
+			else
+			{
+				assets->clear_sprite_atlas();
+			}
+
+			// Start every load now so decoding overlaps object creation
+			for (const asset_t& asset : header.assets)
+			{
+				if (asset.type == AssetType::TEXTURE)
+				{
+					assets->load_texture_region_async(asset.path);
 				}
-				else
+				else if (asset.type == AssetType::FONT)
 				{
-					file_path = std::string(path);
-					free(path);
+					assets->load_font_async(asset.path);
 				}
 			}
 
+			return NFD_OKAY;
+		}
+
+		void finish_project_load()
+		{
+			globals::has_unsaved_changes = false;
+			globals::update_window_title();
+
+			ui::set_input_buffers();
+		}
+
+		/**
+		 * Called instead of finish_project_load() when a load stops
+		 * after begin_project_load(). The scene only holds part of
+		 * the project, so it stays marked as unsaved rather than
+		 * letting it pass for the file it was read from.
+		 */
+		void fail_project_load()
+		{
+			globals::has_unsaved_changes = true;
+			globals::update_window_title();
+
+			ui::set_input_buffers();
+		}
+
+		static nfdresult_t load_json_project(const std::string& file_path, bool& begun)
+		{
+			using json = nlohmann::json;
+
 			// Open project file
 			std::ifstream infile(file_path);
 			if (!infile.is_open())
@@ -143,71 +533,149 @@ namespace bacon
 				return NFD_ERROR;
 			}
 
-			// Save path globals
-			fs::path entry_path = fs::path(file_path);
-			globals::project_file = file_path;
-			globals::project_directory =
-				entry_path.parent_path().generic_string();
-			globals::is_project_loaded = true;
-
 			// Parse json
 			json file_data = json::parse(infile);
 
-			// Get project type
-			GameState::game_type = GameState::GameType::NONE;
-			uint8_t game_type = json_read_uint8(file_data["settings"], "game_type");
-			switch ((GameState::GameType)game_type)
+			ProjectHeader header;
+			read_json_header(file_data["settings"], header);
+
+			nfdresult_t result = begin_project_load(file_path, header);
+			begun = true;
+			if (result != NFD_OKAY || !file_data.contains("objects"))
 			{
-				case GameState::GameType::NONE:
-				{
-					debug_error("Failed to load project: Invalid project type.");
-					return NFD_ERROR;
-				}
+				return result;
+			}
 
-				default:
+			ObjectMemoryScope scope(GameState::state_2d->scene->get_object_memory());
+			for (const json& data : file_data["objects"])
+			{
+				GameObject* object = create_object_from_json(data);
+				if (object != nullptr)
 				{
-					GameState::game_type = GameState::GameType(game_type);
-					break;
+					object->add_to_scene();
 				}
 			}
 
-			// Delete scene data
-			if (GameState::game_type == GameState::GameType::GAME_2D)
+			return NFD_OKAY;
+		}
+
+		static nfdresult_t load_binary_project(const std::string& file_path, bool& begun)
+		{
+			// Objects are read straight out of the mapping
+			MappedFile file(file_path);
+			if (!file.is_open())
 			{
-				if (GameState::state_2d != nullptr && GameState::state_2d->scene != nullptr)
+				debug_error("Failed to load project: file doesn't exist");
+				return NFD_ERROR;
+			}
+			ByteView bytes = file.view();
+
+			try
+			{
+				ProjectHeader header;
+				if (!read_binary_header(bytes, header))
+				{
+					return NFD_ERROR;
+				}
+
+				nfdresult_t result = begin_project_load(file_path, header);
+				begun = true;
+				if (result != NFD_OKAY || GameState::game_type != GameState::GameType::GAME_2D)
 				{
-					GameState::state_2d->scene->reset();
+					return result;
 				}
-				else
+
+				ObjectMemoryScope scope(GameState::state_2d->scene->get_object_memory());
+				uint64_t object_count = read_uint64(bytes);
+				for (uint64_t i = 0; i < object_count; i++)
 				{
-					// Create state if it doesn't exist
-					if (!GameState::state_2d)
+					ByteView object_bytes = bytes.take(read_uint64(bytes));
+
+					// Objects are length-prefixed, so a corrupt one
+					// is skipped without losing the rest
+					GameObject* object = nullptr;
+					try
+					{
+						object = GameObject::create_game_object(object_bytes);
+					}
+					catch (const std::out_of_range&)
+					{
+						object = nullptr;
+					}
+
+					if (object == nullptr)
 					{
-						GameState::state_2d = new GameState2D();
+						debug_error("Skipping invalid object %lu in project.", (unsigned long)i);
+						continue;
 					}
+					object->add_to_scene();
 				}
 			}
+			catch (const std::out_of_range&)
+			{
+				debug_error("Failed to load project: %s is truncated or corrupt.", file_path.c_str());
+				return NFD_ERROR;
+			}
 
-			// Interpret JSON data
-			for (auto it = file_data.begin(); it != file_data.end(); it++)
+			return NFD_OKAY;
+		}
+
+		nfdresult_t pick_project_file(std::string& file_path)
+		{
+			nfdu8char_t* path = NULL;
+			nfdu8filteritem_t filters[1] = {{"Project File", "json,bproj"}};
+			nfdopendialogu8args_t args = {0};
+			args.filterCount = 1;
+			args.filterList = filters;
+			nfdresult_t result = NFD_OpenDialogU8_With(&path, &args);
+
+			if (result == NFD_ERROR)
+			{
+				debug_error("Failed to load project.");
+			}
+			else if (result == NFD_OKAY)
 			{
-				std::string key = it.key();
-				auto value = *it;
+				file_path = std::string(path);
+			}
+
+			free(path);
+			return result;
+		}
+
+		nfdresult_t load_project(bool show_dialog)
+		{
+			debug_log("Loading project...");
+			std::string file_path = globals::project_file;
 
-				if (key == "settings")
+			if (show_dialog)
+			{
+				nfdresult_t result = pick_project_file(file_path);
+				if (result != NFD_OKAY)
 				{
-					parse_project_settings(file_data["settings"]);
+					return result;
 				}
-				else if (key == "objects")
+			}
+
+			// A streaming load would keep adding objects to the new scene
+			if (globals::project_loader != nullptr)
+			{
+				globals::project_loader->cancel();
+			}
+
+			bool begun = false;
+			nfdresult_t result = is_binary_project(file_path)
+				? load_binary_project(file_path, begun)
+				: load_json_project(file_path, begun);
+			if (result != NFD_OKAY)
+			{
+				if (begun)
 				{
-					parse_project_objects(file_data["objects"]);
+					fail_project_load();
 				}
+				return result;
 			}
 
-			globals::has_unsaved_changes = false;
-			globals::update_window_title();
-
-			ui::set_input_buffers();
+			finish_project_load();
 
 			return NFD_OKAY;
 		}
@@ -226,6 +694,8 @@ namespace bacon
 			data["settings"]["title"] = globals::project_title;
 			outfile << std::setw(4) << data;
 
+			globals::texture_sorted_layers = 0;
+
 			// Create folders in project directory
 			fs::create_directory(globals::project_directory +
 								 std::string("/sprites"));
@@ -238,6 +708,12 @@ namespace bacon
 			fs::create_directory(globals::project_directory +
 								 std::string("/sounds"));
 
+			if (GameState::state_2d != nullptr)
+			{
+				GameState::state_2d->assets->set_import_cache(
+					std::make_shared<AssetCache>(globals::project_directory));
+			}
+
 			globals::has_unsaved_changes = false;
 			globals::update_window_title();
 
@@ -246,6 +722,28 @@ namespace bacon
 			return NFD_OKAY;
 		}
 
+		/**
+		 * Decodes the project's sprites and bakes its fonts into
+		 * the import cache ahead of time.
+		 * Returns the number of assets imported.
+		 */
+		size_t import_project_assets()
+		{
+			std::shared_ptr<AssetCache> cache;
+			if (GameState::state_2d != nullptr && GameState::state_2d->assets->get_import_cache() != nullptr)
+			{
+				cache = GameState::state_2d->assets->get_import_cache();
+			}
+			else
+			{
+				cache = std::make_shared<AssetCache>(globals::project_directory);
+			}
+
+			size_t imported = cache->import_directory(globals::project_directory + "/sprites", false);
+			imported += cache->import_directory(globals::project_directory + "/fonts", true);
+			return imported;
+		}
+
 		nfdresult_t save_object_prefab(const GameObject& object)
 		{
 			using json = nlohmann::json;
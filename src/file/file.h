@@ -3,11 +3,13 @@
 #include <memory>
 #include <string>
 #include <cstdint>
+#include <vector>
 
 #include "nfd.h"
 #include "raylib.h"
 
 #include "core/game_object.h"
+#include "lib/byte_view.h"
 
 namespace bacon
 {
@@ -28,12 +30,49 @@ namespace bacon
 			std::string path;
 		} asset_t;
 
+		// Project settings read before any object is created
+		typedef struct
+		{
+			uint8_t game_type;
+			bool sprite_atlas;
+			std::string version;
+			std::string title;
+			float gravity;
+			// Scene2D physics timing
+			bool fixed_timestep;
+			float physics_rate;
+			int32_t max_substeps;
+			// See globals::texture_sorted_layers
+			uint32_t texture_sorted_layers;
+			// Assets to load up front (.bproj only)
+			std::vector<asset_t> assets;
+		} ProjectHeader;
+
 		constexpr nfdfilteritem_t texture_types = {"Images", "png,jpeg,jpg"};
 		constexpr nfdfilteritem_t font_types = {"Font", "ttf"};
 
+		// Binary project files (.bproj) start with "BPRJ"
+		constexpr uint32_t bproj_magic = 0x4A525042;
+		// 2: texture sorted layers, 3: physics timing
+		constexpr uint32_t bproj_version = 3;
+
 		nfdresult_t save_project();
 		nfdresult_t load_project(bool show_dialog);
 		nfdresult_t create_new_project();
+		nfdresult_t pick_project_file(std::string& file_path);
+
+		// Building blocks shared with the streaming ProjectLoader
+		void read_json_header(const nlohmann::json& settings, ProjectHeader& header);
+		bool read_binary_header(ByteView& bytes, ProjectHeader& header);
+		GameObject* create_object_from_json(const nlohmann::json& data);
+		nfdresult_t begin_project_load(const std::string& file_path, const ProjectHeader& header);
+		void finish_project_load();
+		void fail_project_load();
+
+		bool is_binary_project(const std::string& path);
+		bool export_project(const std::string& path);
+		bool convert_project(const std::string& source, const std::string& destination);
+		size_t import_project_assets();
 
 		nfdresult_t save_object_prefab(const GameObject& object);
 		nfdresult_t load_from_prefab(const std::string& path, GameObject& object);
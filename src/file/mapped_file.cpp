@@ -0,0 +1,97 @@
+#include "file/mapped_file.h"
+
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define BACON_HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace bacon
+{
+	MappedFile::MappedFile(const std::string& path)
+	{
+		open(path);
+	}
+
+	MappedFile::~MappedFile()
+	{
+		close();
+	}
+
+	bool MappedFile::open(const std::string& path)
+	{
+		close();
+
+#ifdef BACON_HAS_MMAP
+		int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd >= 0)
+		{
+			struct stat info;
+			if (fstat(fd, &info) == 0)
+			{
+				m_size = (size_t)info.st_size;
+				m_open = true;
+
+				// mmap rejects empty files; an empty view is fine
+				if (m_size > 0)
+				{
+					void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+					if (data != MAP_FAILED)
+					{
+						madvise(data, m_size, MADV_SEQUENTIAL);
+						m_data = (const uint8_t*)data;
+						m_mapped = true;
+					}
+					else
+					{
+						m_open = false;
+						m_size = 0;
+					}
+				}
+			}
+			::close(fd);
+
+			if (m_open)
+			{
+				return true;
+			}
+		}
+#endif
+
+		std::ifstream infile(path, std::ios::binary | std::ios::ate);
+		if (!infile.is_open())
+		{
+			return false;
+		}
+
+		m_buffer.resize((size_t)infile.tellg());
+		infile.seekg(0);
+		infile.read((char*)m_buffer.data(), m_buffer.size());
+
+		m_data = m_buffer.data();
+		m_size = m_buffer.size();
+		m_open = true;
+		return true;
+	}
+
+	void MappedFile::close()
+	{
+#ifdef BACON_HAS_MMAP
+		if (m_mapped)
+		{
+			munmap((void*)m_data, m_size);
+		}
+#endif
+
+		m_buffer.clear();
+		m_buffer.shrink_to_fit();
+		m_data = nullptr;
+		m_size = 0;
+		m_open = false;
+		m_mapped = false;
+	}
+} // namespace bacon
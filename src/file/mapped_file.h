@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "lib/byte_view.h"
+
+namespace bacon
+{
+	/**
+	 * Read-only view of a whole file.
+	 * Uses mmap where available so reading a project doesn't copy
+	 * it into the heap first; other platforms read it into memory.
+	 */
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		explicit MappedFile(const std::string& path);
+		MappedFile(const MappedFile& file) = delete;
+		MappedFile& operator=(const MappedFile& file) = delete;
+		~MappedFile();
+
+		bool open(const std::string& path);
+		void close();
+
+		bool is_open() const { return m_open; }
+		const uint8_t* data() const { return m_data; }
+		size_t size() const { return m_size; }
+		ByteView view() const { return ByteView(m_data, m_size); }
+
+	private:
+		const uint8_t* m_data = nullptr;
+		size_t m_size = 0;
+		bool m_open = false;
+		bool m_mapped = false;
+
+		// Fallback storage when the file couldn't be mapped
+		std::vector<uint8_t> m_buffer;
+	};
+} // namespace bacon
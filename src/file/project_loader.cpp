@@ -0,0 +1,380 @@
+#include "file/project_loader.h"
+
+#include <chrono>
+#include <fstream>
+
+#include "core/2D/game_state_2d.h"
+#include "core/game_object.h"
+#include "core/game_state.h"
+#include "core/profiler.h"
+#include "core/util.h"
+
+namespace bacon
+{
+	ProjectLoader::~ProjectLoader()
+	{
+		cancel();
+	}
+
+	/**
+	 * Starts loading file_path, replacing the current project
+	 * once its header has been read. Call update() every frame
+	 * until is_loading() returns false.
+	 */
+	nfdresult_t ProjectLoader::begin(const std::string& file_path, ProgressCallback progress)
+	{
+		cancel();
+
+		m_file_path = file_path;
+		m_binary = file::is_binary_project(file_path);
+		m_progress = progress;
+
+		if (m_binary && !m_file.open(file_path))
+		{
+			debug_error("Failed to load project: file doesn't exist");
+			return NFD_ERROR;
+		}
+		else if (!m_binary && !std::ifstream(file_path).is_open())
+		{
+			debug_error("Failed to load project: file doesn't exist");
+			return NFD_ERROR;
+		}
+
+		m_header_ready = false;
+		m_parse_done = false;
+		m_failed = false;
+		m_cancel = false;
+		m_total = 0;
+
+		m_loading = true;
+		m_header_applied = false;
+		m_current.clear();
+		m_current_index = 0;
+		m_loaded = 0;
+
+		debug_log("Loading project...");
+		m_thread = std::thread(&ProjectLoader::parse, this);
+
+		return NFD_OKAY;
+	}
+
+	/**
+	 * Applies the header once it is parsed, then creates queued
+	 * objects until the frame budget runs out.
+	 */
+	void ProjectLoader::update()
+	{
+		if (!m_loading)
+		{
+			return;
+		}
+
+		PROFILE_SCOPE("ProjectLoader::update");
+
+		if (!m_header_applied)
+		{
+			file::ProjectHeader header;
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (!m_header_ready)
+				{
+					if (m_failed)
+					{
+						finish(false);
+					}
+					return;
+				}
+				header = m_header;
+			}
+
+			// Set first: a failed begin has already switched project_file
+			m_header_applied = true;
+			if (file::begin_project_load(m_file_path, header) != NFD_OKAY)
+			{
+				finish(false);
+				return;
+			}
+
+			// Other project types have no objects to stream
+			if (GameState::game_type != GameState::GameType::GAME_2D)
+			{
+				finish(true);
+				return;
+			}
+		}
+
+		using clock = std::chrono::steady_clock;
+		clock::time_point start = clock::now();
+		size_t loaded_before = m_loaded;
+
+		ObjectMemoryScope scope(GameState::state_2d->scene->get_object_memory());
+		PendingObject* pending = nullptr;
+		while (next_object(&pending))
+		{
+			GameObject* object = nullptr;
+			if (m_binary)
+			{
+				try
+				{
+					object = GameObject::create_game_object(pending->bytes);
+				}
+				catch (const std::out_of_range&)
+				{
+					object = nullptr;
+				}
+			}
+			else
+			{
+				object = file::create_object_from_json(pending->json);
+			}
+
+			if (object != nullptr)
+			{
+				object->add_to_scene();
+			}
+			else
+			{
+				debug_error("Skipping invalid object %zu in project.", m_loaded);
+			}
+			m_loaded++;
+
+			// Always make progress, even with a tiny budget
+			float elapsed_ms = std::chrono::duration<float, std::milli>(clock::now() - start).count();
+			if (elapsed_ms >= frame_budget_ms)
+			{
+				break;
+			}
+		}
+
+		if (m_progress && m_loaded != loaded_before)
+		{
+			m_progress(m_loaded, m_total);
+		}
+
+		// The worker only sets m_parse_done after queueing its last batch
+		bool done = m_parse_done && m_current_index >= m_current.size();
+		if (done)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			done = m_batches.empty();
+		}
+
+		if (done)
+		{
+			finish(!m_failed);
+		}
+	}
+
+	/**
+	 * Stops loading. Objects created so far stay in the scene.
+	 */
+	void ProjectLoader::cancel()
+	{
+		m_cancel = true;
+		if (m_thread.joinable())
+		{
+			m_thread.join();
+		}
+
+		if (m_loading)
+		{
+			debug_log("Project load cancelled after %zu objects.", m_loaded);
+			if (m_header_applied)
+			{
+				file::fail_project_load();
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_batches.clear();
+		m_current.clear();
+		m_current_index = 0;
+		m_file.close();
+		m_loading = false;
+	}
+
+	float ProjectLoader::get_progress() const
+	{
+		size_t total = m_total;
+		if (total == 0)
+		{
+			return m_loading ? 0.f : 1.f;
+		}
+
+		return (float)m_loaded / (float)total;
+	}
+
+	void ProjectLoader::parse()
+	{
+		profiler::set_thread_name("Project Loader");
+		PROFILE_SCOPE("ProjectLoader::parse");
+
+		if (m_binary)
+		{
+			parse_binary();
+		}
+		else
+		{
+			parse_json();
+		}
+
+		m_parse_done = true;
+	}
+
+	void ProjectLoader::parse_json()
+	{
+		using json = nlohmann::json;
+
+		json file_data;
+		try
+		{
+			std::ifstream infile(m_file_path);
+			file_data = json::parse(infile);
+		}
+		catch (const json::exception& e)
+		{
+			debug_error("Failed to parse project: %s", e.what());
+			m_failed = true;
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			file::read_json_header(file_data["settings"], m_header);
+			m_header_ready = true;
+		}
+
+		if (!file_data.contains("objects"))
+		{
+			return;
+		}
+
+		json& objects = file_data["objects"];
+		m_total = objects.size();
+
+		std::vector<PendingObject> batch;
+		for (json& data : objects)
+		{
+			if (m_cancel)
+			{
+				return;
+			}
+
+			batch.push_back({std::move(data), ByteView()});
+			if (batch.size() >= _BATCH_SIZE)
+			{
+				push_batch(batch);
+			}
+		}
+		push_batch(batch);
+	}
+
+	void ProjectLoader::parse_binary()
+	{
+		ByteView bytes = m_file.view();
+
+		try
+		{
+			file::ProjectHeader header;
+			if (!file::read_binary_header(bytes, header))
+			{
+				m_failed = true;
+				return;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_header = std::move(header);
+				m_header_ready = true;
+			}
+
+			uint64_t object_count = read_uint64(bytes);
+			m_total = object_count;
+
+			// Each record is a view into the mapping, so batching
+			// only slices the file into objects.
+			std::vector<PendingObject> batch;
+			for (uint64_t i = 0; i < object_count; i++)
+			{
+				if (m_cancel)
+				{
+					return;
+				}
+
+				ByteView object_bytes = bytes.take(read_uint64(bytes));
+				batch.push_back({nlohmann::json(), object_bytes});
+				if (batch.size() >= _BATCH_SIZE)
+				{
+					push_batch(batch);
+				}
+			}
+			push_batch(batch);
+		}
+		catch (const std::out_of_range&)
+		{
+			debug_error("Failed to load project: %s is truncated or corrupt.", m_file_path.c_str());
+			m_failed = true;
+		}
+	}
+
+	void ProjectLoader::push_batch(std::vector<PendingObject>& batch)
+	{
+		if (batch.empty())
+		{
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_batches.push_back(std::move(batch));
+		batch.clear();
+		batch.reserve(_BATCH_SIZE);
+	}
+
+	bool ProjectLoader::next_object(PendingObject** object)
+	{
+		if (m_current_index >= m_current.size())
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_batches.empty())
+			{
+				return false;
+			}
+
+			m_current = std::move(m_batches.front());
+			m_batches.pop_front();
+			m_current_index = 0;
+		}
+
+		*object = &m_current[m_current_index++];
+		return true;
+	}
+
+	void ProjectLoader::finish(bool success)
+	{
+		if (m_thread.joinable())
+		{
+			m_thread.join();
+		}
+
+		m_current.clear();
+		m_current_index = 0;
+		m_file.close();
+		m_loading = false;
+
+		if (success)
+		{
+			file::finish_project_load();
+			debug_log("Project loaded (%zu objects).", m_loaded);
+		}
+		else
+		{
+			// A partial scene must not be saved over the full file
+			// as if nothing was lost
+			if (m_header_applied)
+			{
+				file::fail_project_load();
+			}
+			debug_error("Failed to load project: %s", m_file_path.c_str());
+		}
+	}
+} // namespace bacon
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "nfd.h"
+#include "nlohmann/json.hpp"
+
+#include "file/file.h"
+#include "file/mapped_file.h"
+#include "lib/byte_view.h"
+
+namespace bacon
+{
+	/**
+	 * Loads a project over several frames.
+	 * A worker thread parses the file and queues batches of object
+	 * records; update() turns them into scene objects on the main
+	 * thread until frame_budget_ms is used up. Objects can't be
+	 * built off the main thread since they allocate transform
+	 * slots and upload textures.
+	 */
+	class ProjectLoader
+	{
+	public:
+		typedef std::function<void(size_t loaded, size_t total)> ProgressCallback;
+
+		static constexpr size_t _BATCH_SIZE = 256;
+
+		// Main thread time spent creating objects per update()
+		float frame_budget_ms = 4.f;
+
+		ProjectLoader() = default;
+		ProjectLoader(const ProjectLoader& loader) = delete;
+		ProjectLoader& operator=(const ProjectLoader& loader) = delete;
+		~ProjectLoader();
+
+		nfdresult_t begin(const std::string& file_path, ProgressCallback progress = nullptr);
+		void update();
+		void cancel();
+
+		bool is_loading() const { return m_loading; }
+		size_t get_loaded_count() const { return m_loaded; }
+		size_t get_total_count() const { return m_total; }
+		float get_progress() const;
+
+	private:
+		// One object waiting to be created; which member is used
+		// depends on the file format.
+		typedef struct
+		{
+			nlohmann::json json;
+			ByteView bytes;
+		} PendingObject;
+
+		std::string m_file_path;
+		bool m_binary = false;
+		MappedFile m_file;
+		ProgressCallback m_progress;
+
+		std::thread m_thread;
+		std::mutex m_mutex;
+		std::deque<std::vector<PendingObject>> m_batches;
+		file::ProjectHeader m_header;
+		bool m_header_ready = false;
+		std::atomic<bool> m_parse_done = false;
+		std::atomic<bool> m_failed = false;
+		std::atomic<bool> m_cancel = false;
+		std::atomic<size_t> m_total = 0;
+
+		// Main thread only
+		bool m_loading = false;
+		bool m_header_applied = false;
+		std::vector<PendingObject> m_current;
+		size_t m_current_index = 0;
+		size_t m_loaded = 0;
+
+		void parse();
+		void parse_json();
+		void parse_binary();
+		void push_batch(std::vector<PendingObject>& batch);
+		bool next_object(PendingObject** object);
+		void finish(bool success);
+	};
+} // namespace bacon
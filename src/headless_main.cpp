@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "raylib.h"
+
+#include "core/game_state.h"
+#include "core/globals.h"
+#include "core/job_system.h"
+#include "core/util.h"
+#include "file/file.h"
+
+/*
+ * Runs a project's physics without a window or GPU.
+ *
+ * Usage: bacon_headless <project> [--steps N] [--dt SECONDS] [--workers N]
+ *                       [--convert OUTPUT] [--import-assets]
+ *
+ * --convert writes the project out in the format of OUTPUT's
+ * extension (.json or .bproj) instead of simulating.
+ * --import-assets fills the project's asset import cache with its
+ * sprites and fonts instead of simulating.
+ */
+
+static void print_usage()
+{
+	printf("Usage: bacon_headless <project> [--steps N] [--dt SECONDS] [--workers N] [--convert OUTPUT] [--import-assets]\n");
+}
+
+int main(int argc, char** argv)
+{
+	using namespace bacon;
+	using clock = std::chrono::steady_clock;
+
+	std::string project_file;
+	int step_count = 600;
+	float delta_time = 1.f / 60.f;
+	uint32_t worker_count = 0;
+	std::string convert_file;
+	bool import_assets = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--steps") == 0 && i + 1 < argc)
+		{
+			step_count = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--dt") == 0 && i + 1 < argc)
+		{
+			delta_time = (float)atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc)
+		{
+			worker_count = (uint32_t)atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--convert") == 0 && i + 1 < argc)
+		{
+			convert_file = argv[++i];
+		}
+		else if (strcmp(argv[i], "--import-assets") == 0)
+		{
+			import_assets = true;
+		}
+		else if (argv[i][0] == '-')
+		{
+			print_usage();
+			return 1;
+		}
+		else
+		{
+			project_file = argv[i];
+		}
+	}
+
+	if (project_file.empty() || step_count <= 0 || delta_time <= 0.f)
+	{
+		print_usage();
+		return 1;
+	}
+
+	SetTraceLogLevel(LOG_WARNING);
+
+	globals::engine_version = "v0.1";
+	globals::job_system = new JobSystem(worker_count);
+
+	// Created up front so load_project reuses it instead of
+	// making one with a renderer.
+	GameState::state_2d = new GameState2D(true);
+
+	if (!convert_file.empty())
+	{
+		bool converted = file::convert_project(project_file, convert_file);
+		GameState::cleanup();
+		delete globals::job_system;
+		globals::job_system = nullptr;
+
+		if (!converted)
+		{
+			fprintf(stderr, "Failed to convert %s to %s\n", project_file.c_str(), convert_file.c_str());
+			return 1;
+		}
+
+		printf("Converted %s to %s\n", project_file.c_str(), convert_file.c_str());
+		return 0;
+	}
+
+	if (import_assets)
+	{
+		std::filesystem::path directory = std::filesystem::path(project_file).parent_path();
+		globals::project_directory = directory.empty() ? "." : directory.generic_string();
+
+		clock::time_point start = clock::now();
+		size_t imported = file::import_project_assets();
+		double elapsed_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+		GameState::cleanup();
+		delete globals::job_system;
+		globals::job_system = nullptr;
+
+		printf("Imported %zu assets in %.1f ms\n", imported, elapsed_ms);
+		return 0;
+	}
+
+	globals::project_file = project_file;
+	if (file::load_project(false) != NFD_OKAY)
+	{
+		fprintf(stderr, "Failed to load project: %s\n", project_file.c_str());
+		return 1;
+	}
+
+	if (GameState::game_type != GameState::GameType::GAME_2D)
+	{
+		fprintf(stderr, "Only 2D projects can run headless.\n");
+		return 1;
+	}
+
+	Scene2D* scene = GameState::state_2d->scene;
+	scene->create_physics_bodies();
+
+	size_t body_count = 0;
+	for (Entity2D* entity : scene->get_entities())
+	{
+		if (entity->get_body_type() != BodyType::NONE)
+			body_count++;
+	}
+
+	printf("Project:  %s\n", project_file.c_str());
+	printf("Objects:  %zu (%zu physics bodies)\n", scene->get_objects().size(), body_count);
+	printf("Workers:  %u\n", globals::job_system->get_worker_count());
+	printf("Steps:    %d x %.4f s\n", step_count, delta_time);
+
+	std::vector<double> step_ms;
+	step_ms.reserve(step_count);
+
+	clock::time_point run_start = clock::now();
+	for (int i = 0; i < step_count; i++)
+	{
+		clock::time_point start = clock::now();
+		scene->simulation_step(delta_time);
+		step_ms.push_back(std::chrono::duration<double, std::milli>(clock::now() - start).count());
+	}
+	double total_ms = std::chrono::duration<double, std::milli>(clock::now() - run_start).count();
+
+	std::vector<double> sorted = step_ms;
+	std::sort(sorted.begin(), sorted.end());
+	auto percentile = [&sorted](double p)
+	{
+		size_t index = (size_t)(p * (sorted.size() - 1));
+		return sorted[index];
+	};
+
+	printf("Total:    %.3f ms\n", total_ms);
+	printf("Step avg: %.4f ms\n", total_ms / step_count);
+	printf("Step min: %.4f ms\n", sorted.front());
+	printf("Step p50: %.4f ms\n", percentile(0.50));
+	printf("Step p99: %.4f ms\n", percentile(0.99));
+	printf("Step max: %.4f ms\n", sorted.back());
+
+	GameState::cleanup();
+	delete globals::job_system;
+	globals::job_system = nullptr;
+
+	return 0;
+}
@@ -2,12 +2,20 @@
 
 #include <type_traits>
 #include <cstdint>
+#include <cstring>
 #include <vector>
 #include <string>
 #include <stdexcept>
 
+#include "lib/byte_view.h"
+
 namespace bacon
 {
+	/**
+	 * Growable byte buffer for serialization. Values are written
+	 * little-endian and lengths and counts as uint64, so the
+	 * output is the same on every host (see ByteView).
+	 */
 	class ByteStream
 	{
 		public:
@@ -21,22 +29,47 @@ namespace bacon
 
 			size_t read_pos() const noexcept { return m_read_pos; }
 			void reset_read() noexcept { m_read_pos = 0; }
+			void reserve(size_t capacity) { m_raw.reserve(capacity); }
+
+			// Reader over the bytes written so far; invalidated by further writes
+			ByteView view() const noexcept { return ByteView(m_raw.data(), m_raw.size()); }
+
+			/**
+			 * Writes a placeholder length and returns its position.
+			 * Append the payload in place, then call end_length_prefix()
+			 * with the position to fill the length in.
+			 */
+			size_t begin_length_prefix()
+			{
+				size_t position = m_raw.size();
+				*this << static_cast<uint64_t>(0);
+				return position;
+			}
+
+			void end_length_prefix(size_t position)
+			{
+				uint64_t length = m_raw.size() - position - sizeof(uint64_t);
+				swap_little_endian<uint64_t>(reinterpret_cast<uint8_t*>(&length));
+				memcpy(m_raw.data() + position, &length, sizeof(uint64_t));
+			}
 
 			template <typename T,
 				typename = std::enable_if_t<std::is_arithmetic_v<T>>>
 			ByteStream& operator<<(T value)
 			{
-				const auto* ptr = reinterpret_cast<const uint8_t*>(&value);
+				auto* ptr = reinterpret_cast<uint8_t*>(&value);
+				swap_little_endian<T>(ptr);
 				m_raw.insert(m_raw.end(), ptr, ptr + sizeof(T));
 				return *this;
 			}
 
-			ByteStream& operator<<(const std::string& str)
+			// Any allocator, so pmr strings serialize the same way
+			template <typename Allocator>
+			ByteStream& operator<<(const std::basic_string<char, std::char_traits<char>, Allocator>& str)
 			{
-				size_t len = str.size();
-				*this << len;
+				*this << static_cast<uint64_t>(str.size());
 				const uint8_t* bytes = reinterpret_cast<const uint8_t*>(str.data());
-				m_raw.insert(m_raw.end(), bytes, bytes + len);
+				m_raw.insert(m_raw.end(), bytes, bytes + str.size());
 				return *this;
 			}
 
@@ -44,8 +77,7 @@ namespace bacon
 				typename = std::enable_if<std::is_arithmetic_v<T>>>
 			ByteStream& operator<<(const std::vector<T>& vec)
 			{
-				size_t count = static_cast<size_t>(vec.size());
-				*this << count;
+				*this << static_cast<uint64_t>(vec.size());
 				for (const auto& item : vec)
 					*this << item;
 				return *this;
@@ -58,13 +90,15 @@ namespace bacon
 				check_remaining(sizeof(T));
 				auto* ptr = reinterpret_cast<uint8_t*>(&value);
 				std::copy(m_raw.begin() + m_read_pos, m_raw.begin() + m_read_pos + sizeof(T), ptr);
+				swap_little_endian<T>(ptr);
 				m_read_pos += sizeof(T);
 				return *this;
 			}
 
-			ByteStream& operator>>(std::string& str)
+			template <typename Allocator>
+			ByteStream& operator>>(std::basic_string<char, std::char_traits<char>, Allocator>& str)
 			{
-				size_t len;
+				uint64_t len;
 				*this >> len;
 
 				check_remaining(len);
@@ -78,7 +112,7 @@ namespace bacon
               typename = std::enable_if_t<std::is_arithmetic_v<T>>>
 			ByteStream& operator>>(std::vector<T>& vec)
 			{
-				size_t len;
+				uint64_t len;
 				*this >> len;
 				vec.resize(len);
 				for (auto& v : vec)
@@ -90,27 +124,27 @@ namespace bacon
 			std::vector<uint8_t> m_raw;
 			size_t m_read_pos = 0;
 
-			void check_remaining(size_t needed) const
+			void check_remaining(uint64_t needed) const
 			{
 				if (m_read_pos + needed > m_raw.size())
 					throw std::out_of_range("ByteStream: read past end");
 			}
 	};
 
-	template <typename T,
-		typename = std::enable_if<std::is_arithmetic_v<T>>>
-	T read_value(ByteStream& bytes)
+	// Readers shared by ByteStream and ByteView
+
+	template <typename T, typename Stream>
+	T read_value(Stream& bytes)
 	{
 		T value;
 		bytes >> value;
 		return value;
 	}
 
-	template <typename T,
-		typename = std::enable_if<std::is_arithmetic_v<T>>>
-	std::vector<T> read_vector(ByteStream& bytes)
+	template <typename T, typename Stream>
+	std::vector<T> read_vector(Stream& bytes)
 	{
-		uint32_t count;
+		uint64_t count;
 		bytes >> count;
 		std::vector<T> vec(count);
 		for (auto& item : vec)
@@ -118,22 +152,23 @@ namespace bacon
 		return vec;
 	}
 
-	inline std::string read_string(ByteStream& bytes)
+	template <typename Stream>
+	inline std::string read_string(Stream& bytes)
 	{
 		std::string out;
 		bytes >> out;
 		return out;
 	}
 
-	inline int8_t read_int8(ByteStream& bytes) { return read_value<int8_t>(bytes); }
-	inline int16_t read_int16(ByteStream& bytes) { return read_value<int16_t>(bytes); }
-	inline int32_t read_int32(ByteStream& bytes) { return read_value<int32_t>(bytes); }
-	inline int64_t read_int64(ByteStream& bytes) { return read_value<int64_t>(bytes); }
-	inline uint8_t read_uint8(ByteStream& bytes) { return read_value<uint8_t>(bytes); }
-	inline uint16_t read_uint16(ByteStream& bytes) { return read_value<uint16_t>(bytes); }
-	inline uint32_t read_uint32(ByteStream& bytes) { return read_value<uint32_t>(bytes); }
-	inline uint64_t read_uint64(ByteStream& bytes) { return read_value<uint64_t>(bytes); }
-	inline float read_float(ByteStream& bytes) { return read_value<float>(bytes); }
-	inline double read_double(ByteStream& bytes) { return read_value<double>(bytes); }
-	inline bool read_bool(ByteStream& bytes) { return read_value<bool>(bytes); }
+	template <typename Stream> inline int8_t read_int8(Stream& bytes) { return read_value<int8_t>(bytes); }
+	template <typename Stream> inline int16_t read_int16(Stream& bytes) { return read_value<int16_t>(bytes); }
+	template <typename Stream> inline int32_t read_int32(Stream& bytes) { return read_value<int32_t>(bytes); }
+	template <typename Stream> inline int64_t read_int64(Stream& bytes) { return read_value<int64_t>(bytes); }
+	template <typename Stream> inline uint8_t read_uint8(Stream& bytes) { return read_value<uint8_t>(bytes); }
+	template <typename Stream> inline uint16_t read_uint16(Stream& bytes) { return read_value<uint16_t>(bytes); }
+	template <typename Stream> inline uint32_t read_uint32(Stream& bytes) { return read_value<uint32_t>(bytes); }
+	template <typename Stream> inline uint64_t read_uint64(Stream& bytes) { return read_value<uint64_t>(bytes); }
+	template <typename Stream> inline float read_float(Stream& bytes) { return read_value<float>(bytes); }
+	template <typename Stream> inline double read_double(Stream& bytes) { return read_value<double>(bytes); }
+	template <typename Stream> inline bool read_bool(Stream& bytes) { return read_value<bool>(bytes); }
 } // namespace bacon
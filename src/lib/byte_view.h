@@ -0,0 +1,131 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <type_traits>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <stdexcept>
+#include <vector>
+
+namespace bacon
+{
+	/**
+	 * Serialized values are little-endian whatever the host, so
+	 * project files move between machines. This swaps the bytes
+	 * of a value between the host and file order in place.
+	 */
+	template <typename T>
+	inline void swap_little_endian(uint8_t* bytes)
+	{
+		if constexpr (std::endian::native == std::endian::big && sizeof(T) > 1)
+		{
+			std::reverse(bytes, bytes + sizeof(T));
+		}
+	}
+
+	/**
+	 * Non-owning reader over bytes written by ByteStream.
+	 * The memory (a ByteStream, a mapped file, ...) must outlive
+	 * the view. Reads past the end throw std::out_of_range.
+	 *
+	 * Values are little-endian; lengths and counts are uint64.
+	 */
+	class ByteView
+	{
+		public:
+			ByteView() = default;
+			ByteView(const uint8_t* data, size_t size) : m_data(data), m_size(size) {}
+			~ByteView() = default;
+
+			const uint8_t* data() const noexcept { return m_data; }
+			size_t size() const noexcept { return m_size; }
+			bool empty() const noexcept { return m_size == 0; }
+
+			size_t read_pos() const noexcept { return m_read_pos; }
+			size_t remaining() const noexcept { return m_size - m_read_pos; }
+			void reset_read() noexcept { m_read_pos = 0; }
+
+			template <typename T,
+				typename = std::enable_if_t<std::is_arithmetic_v<T> || std::is_enum_v<T>>>
+			ByteView& operator>>(T& value)
+			{
+				check_remaining(sizeof(T));
+				memcpy(&value, m_data + m_read_pos, sizeof(T));
+				swap_little_endian<T>(reinterpret_cast<uint8_t*>(&value));
+				m_read_pos += sizeof(T);
+				return *this;
+			}
+
+			// Keeps the string's allocator, e.g. a scene arena
+			template <typename Allocator>
+			ByteView& operator>>(std::basic_string<char, std::char_traits<char>, Allocator>& str)
+			{
+				str = read_string_view();
+				return *this;
+			}
+
+			template <typename T,
+				typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+			ByteView& operator>>(std::vector<T>& vec)
+			{
+				uint64_t len;
+				*this >> len;
+				if (len > remaining() / sizeof(T))
+					throw std::out_of_range("ByteView: read past end");
+				vec.resize(len);
+				memcpy(vec.data(), m_data + m_read_pos, len * sizeof(T));
+				for (T& item : vec)
+					swap_little_endian<T>(reinterpret_cast<uint8_t*>(&item));
+				m_read_pos += len * sizeof(T);
+				return *this;
+			}
+
+			/**
+			 * Reads a length-prefixed string without copying it.
+			 * Valid for as long as the underlying memory.
+			 */
+			std::string_view read_string_view()
+			{
+				uint64_t len;
+				*this >> len;
+
+				check_remaining(len);
+				std::string_view str(reinterpret_cast<const char*>(m_data + m_read_pos), len);
+				m_read_pos += len;
+
+				return str;
+			}
+
+			/**
+			 * Returns the next length bytes as their own view and
+			 * moves past them, e.g. for length-prefixed payloads.
+			 */
+			ByteView take(uint64_t length)
+			{
+				check_remaining(length);
+				ByteView view(m_data + m_read_pos, length);
+				m_read_pos += length;
+				return view;
+			}
+
+			void skip(uint64_t length)
+			{
+				check_remaining(length);
+				m_read_pos += length;
+			}
+
+		private:
+			const uint8_t* m_data = nullptr;
+			size_t m_size = 0;
+			size_t m_read_pos = 0;
+
+			void check_remaining(uint64_t needed) const
+			{
+				if (needed > m_size - m_read_pos)
+					throw std::out_of_range("ByteView: read past end");
+			}
+	};
+} // namespace bacon
@@ -0,0 +1,546 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace bacon
+{
+	/**
+	 * Thread-safe counterpart of PoolAllocator.
+	 *
+	 * Every thread keeps two magazines (small stacks of free slots)
+	 * per pool and allocates from and frees into them without any
+	 * synchronisation. Only when both are empty, or both are full,
+	 * does it trade a whole magazine with the depot: two lock-free
+	 * stacks, one of full magazines and one of empty ones. Carving
+	 * fresh slots out of a new block is the only step under a lock.
+	 *
+	 * Objects may be freed on another thread than the one that
+	 * allocated them; the slot just joins the freeing thread's
+	 * magazine. A thread's magazines go back to the depot when it
+	 * exits, and the pool's memory is released once the pool and
+	 * every thread that used it are gone.
+	 *
+	 * begin()/end() visit live objects like PoolAllocator's, but are
+	 * only valid while no other thread allocates or frees.
+	 */
+	template <typename T>
+	class ConcurrentPoolAllocator
+	{
+	public:
+		static constexpr uint32_t _MAGAZINE_SIZE = 32;
+
+	private:
+		static constexpr uint32_t _CHUNK_MAGAZINES = 1024;
+		static constexpr uint32_t _MAX_CHUNKS = 1024;
+
+		struct Block;
+
+		typedef struct Slot
+		{
+			Block* block;
+			alignas(T) unsigned char storage[sizeof(T)];
+		} Slot;
+
+		typedef struct Block
+		{
+			Slot* slots;
+			// Slots carved into magazines so far
+			size_t used;
+			std::unique_ptr<std::atomic<uint64_t>[]> occupied;
+			size_t words;
+		} Block;
+
+		typedef struct Magazine
+		{
+			// Index + 1 of the magazine below this one in a depot stack
+			std::atomic<uint32_t> next;
+			uint32_t index;
+			uint32_t count;
+			Slot* slots[_MAGAZINE_SIZE];
+		} Magazine;
+
+		/**
+		 * State shared by the pool and the thread caches that use it,
+		 * so whichever of them goes last frees the memory.
+		 */
+		class Depot
+		{
+		public:
+			explicit Depot(size_t block_size) : m_block_size(block_size)
+			{
+				for (std::atomic<Magazine*>& chunk : m_chunks)
+				{
+					chunk.store(nullptr, std::memory_order_relaxed);
+				}
+			}
+
+			Depot(const Depot& depot) = delete;
+			Depot& operator=(const Depot& depot) = delete;
+
+			~Depot()
+			{
+				for (std::atomic<Magazine*>& chunk : m_chunks)
+				{
+					delete[] chunk.load(std::memory_order_relaxed);
+				}
+
+				for (Block* block : m_blocks)
+				{
+					::operator delete(block->slots, std::align_val_t(alignof(Slot)));
+					delete block;
+				}
+			}
+
+			Magazine* pop_full() { return pop(m_full); }
+			void push_full(Magazine* magazine) { push(m_full, magazine); }
+
+			Magazine* take_empty()
+			{
+				Magazine* magazine = pop(m_empty);
+				if (magazine == nullptr)
+				{
+					magazine = new_magazine();
+				}
+
+				magazine->count = 0;
+				return magazine;
+			}
+
+			// Returns a thread's magazine to whichever stack it belongs on
+			void release(Magazine* magazine)
+			{
+				if (magazine != nullptr)
+				{
+					push((magazine->count > 0) ? m_full : m_empty, magazine);
+				}
+			}
+
+			/**
+			 * A magazine of slots that were never handed out, for when
+			 * the depot has no full magazines left.
+			 */
+			Magazine* fill()
+			{
+				Magazine* magazine = take_empty();
+
+				std::lock_guard<std::mutex> lock(m_grow_mutex);
+				while (magazine->count < _MAGAZINE_SIZE)
+				{
+					if (m_current == nullptr || m_current->used == m_block_size)
+					{
+						m_current = new_block();
+					}
+
+					size_t take = std::min<size_t>(_MAGAZINE_SIZE - magazine->count,
+						m_block_size - m_current->used);
+					// Pushed in reverse, so the magazine pops them in address order
+					for (size_t i = take; i > 0; i--)
+					{
+						magazine->slots[magazine->count + i - 1] = m_current->slots + m_current->used + take - i;
+					}
+					magazine->count += (uint32_t)take;
+					m_current->used += take;
+				}
+
+				return magazine;
+			}
+
+			void close() { m_open.store(false, std::memory_order_release); }
+			bool is_open() const { return m_open.load(std::memory_order_acquire); }
+
+			size_t get_block_size() const { return m_block_size; }
+
+			size_t get_block_count()
+			{
+				std::lock_guard<std::mutex> lock(m_grow_mutex);
+				return m_blocks.size();
+			}
+
+			size_t get_magazine_count() const { return m_magazine_count.load(std::memory_order_relaxed); }
+
+			// Unsynchronised; see begin()
+			const std::vector<Block*>& get_blocks() const { return m_blocks; }
+
+		private:
+			size_t m_block_size;
+			std::atomic<bool> m_open = true;
+
+			/**
+			 * Treiber stacks. The low 32 bits hold the index + 1 of the
+			 * top magazine, the high 32 bits a count of changes, so a pop
+			 * that raced with another thread popping and re-pushing the
+			 * same magazine fails its exchange instead of installing a
+			 * stale link.
+			 */
+			std::atomic<uint64_t> m_full = 0;
+			std::atomic<uint64_t> m_empty = 0;
+
+			// Magazines are never freed before the depot, and are found by
+			// index, which is what lets the stacks above hold indices
+			std::atomic<Magazine*> m_chunks[_MAX_CHUNKS];
+			std::atomic<uint32_t> m_magazine_count = 0;
+
+			std::mutex m_grow_mutex;
+			std::vector<Block*> m_blocks;
+			Block* m_current = nullptr;
+
+			Magazine* get_magazine(uint32_t index) const
+			{
+				Magazine* chunk = m_chunks[index / _CHUNK_MAGAZINES].load(std::memory_order_acquire);
+				return chunk + (index % _CHUNK_MAGAZINES);
+			}
+
+			static uint64_t next_top(uint64_t top, uint32_t link)
+			{
+				return (((top >> 32) + 1) << 32) | link;
+			}
+
+			void push(std::atomic<uint64_t>& stack, Magazine* magazine)
+			{
+				uint64_t top = stack.load(std::memory_order_relaxed);
+				uint64_t new_top;
+				do
+				{
+					magazine->next.store((uint32_t)top, std::memory_order_relaxed);
+					new_top = next_top(top, magazine->index + 1);
+				} while (!stack.compare_exchange_weak(top, new_top,
+					std::memory_order_release, std::memory_order_relaxed));
+			}
+
+			Magazine* pop(std::atomic<uint64_t>& stack)
+			{
+				uint64_t top = stack.load(std::memory_order_acquire);
+				while (true)
+				{
+					uint32_t link = (uint32_t)top;
+					if (link == 0)
+					{
+						return nullptr;
+					}
+
+					// May read a link that is already stale; the count in
+					// `top` makes the exchange fail in that case
+					Magazine* magazine = get_magazine(link - 1);
+					uint32_t next = magazine->next.load(std::memory_order_relaxed);
+					if (stack.compare_exchange_weak(top, next_top(top, next),
+						std::memory_order_acquire, std::memory_order_acquire))
+					{
+						return magazine;
+					}
+				}
+			}
+
+			Magazine* new_magazine()
+			{
+				uint32_t index = m_magazine_count.fetch_add(1, std::memory_order_relaxed);
+				uint32_t chunk_index = index / _CHUNK_MAGAZINES;
+				if (chunk_index >= _MAX_CHUNKS)
+				{
+					throw std::bad_alloc();
+				}
+
+				std::atomic<Magazine*>& chunk = m_chunks[chunk_index];
+				if (chunk.load(std::memory_order_acquire) == nullptr)
+				{
+					Magazine* magazines = new Magazine[_CHUNK_MAGAZINES];
+					for (uint32_t i = 0; i < _CHUNK_MAGAZINES; i++)
+					{
+						magazines[i].next.store(0, std::memory_order_relaxed);
+						magazines[i].index = chunk_index * _CHUNK_MAGAZINES + i;
+						magazines[i].count = 0;
+					}
+
+					// Another thread may have installed the chunk meanwhile
+					Magazine* expected = nullptr;
+					if (!chunk.compare_exchange_strong(expected, magazines,
+						std::memory_order_acq_rel, std::memory_order_acquire))
+					{
+						delete[] magazines;
+					}
+				}
+
+				return get_magazine(index);
+			}
+
+			Block* new_block()
+			{
+				Block* block = new Block;
+				block->slots = static_cast<Slot*>(
+					::operator new(sizeof(Slot) * m_block_size, std::align_val_t(alignof(Slot))));
+				block->used = 0;
+				block->words = (m_block_size + 63) / 64;
+				block->occupied = std::make_unique<std::atomic<uint64_t>[]>(block->words);
+				for (size_t i = 0; i < block->words; i++)
+				{
+					block->occupied[i].store(0, std::memory_order_relaxed);
+				}
+				for (size_t i = 0; i < m_block_size; i++)
+				{
+					block->slots[i].block = block;
+				}
+
+				auto it = std::upper_bound(m_blocks.begin(), m_blocks.end(), block,
+					[](const Block* a, const Block* b)
+					{
+						return std::less<const Slot*>()(a->slots, b->slots);
+					});
+				m_blocks.insert(it, block);
+
+				return block;
+			}
+		};
+
+		typedef struct ThreadCache
+		{
+			std::shared_ptr<Depot> depot;
+			Magazine* loaded = nullptr;
+			Magazine* previous = nullptr;
+
+			~ThreadCache()
+			{
+				depot->release(loaded);
+				depot->release(previous);
+			}
+		} ThreadCache;
+
+	public:
+		/**
+		 * Visits live objects in address order. Same rules as
+		 * PoolAllocator's iterator, and no other thread may touch the
+		 * pool during the walk.
+		 */
+		class Iterator
+		{
+		public:
+			Iterator(Block* const* block, Block* const* end) : m_block(block), m_end(end)
+			{
+				seek();
+			}
+
+			T* operator*() const
+			{
+				return reinterpret_cast<T*>((*m_block)->slots[m_index].storage);
+			}
+
+			Iterator& operator++()
+			{
+				m_index++;
+				seek();
+				return *this;
+			}
+
+			bool operator==(const Iterator& other) const
+			{
+				return m_block == other.m_block && m_index == other.m_index;
+			}
+
+			bool operator!=(const Iterator& other) const
+			{
+				return !(*this == other);
+			}
+
+		private:
+			Block* const* m_block;
+			Block* const* m_end;
+			size_t m_index = 0;
+
+			// Moves to the first live slot at or after the current one
+			void seek()
+			{
+				while (m_block != m_end)
+				{
+					const Block& block = **m_block;
+					size_t word = m_index / 64;
+					if (word < block.words)
+					{
+						uint64_t bits = block.occupied[word].load(std::memory_order_relaxed) & (~0ull << (m_index % 64));
+						while (bits == 0 && ++word < block.words)
+						{
+							bits = block.occupied[word].load(std::memory_order_relaxed);
+						}
+
+						if (bits != 0)
+						{
+							m_index = word * 64 + (size_t)std::countr_zero(bits);
+							return;
+						}
+					}
+
+					m_block++;
+					m_index = 0;
+				}
+			}
+		};
+
+		explicit ConcurrentPoolAllocator(size_t block_size)
+		{
+			m_depot = std::make_shared<Depot>(std::max<size_t>(block_size, 1));
+		}
+
+		ConcurrentPoolAllocator(const ConcurrentPoolAllocator& pool) = delete;
+		ConcurrentPoolAllocator& operator=(const ConcurrentPoolAllocator& pool) = delete;
+
+		~ConcurrentPoolAllocator()
+		{
+			// Thread caches still holding the depot drop it the next time
+			// their thread misses, or when it exits
+			m_depot->close();
+		}
+
+		T* allocate()
+		{
+			ThreadCache& cache = local_cache();
+			if (cache.loaded == nullptr || cache.loaded->count == 0)
+			{
+				if (cache.previous != nullptr && cache.previous->count > 0)
+				{
+					std::swap(cache.loaded, cache.previous);
+				}
+				else
+				{
+					Magazine* full = m_depot->pop_full();
+					if (full == nullptr)
+					{
+						full = m_depot->fill();
+					}
+
+					m_depot->release(cache.loaded);
+					cache.loaded = full;
+				}
+			}
+
+			Slot* slot = cache.loaded->slots[--cache.loaded->count];
+			Block* block = slot->block;
+			size_t index = (size_t)(slot - block->slots);
+			block->occupied[index / 64].fetch_or(1ull << (index % 64), std::memory_order_relaxed);
+
+			return reinterpret_cast<T*>(slot->storage);
+		}
+
+		void deallocate(T* ptr)
+		{
+			if (ptr == nullptr)
+			{
+				return;
+			}
+
+			Slot* slot = reinterpret_cast<Slot*>(reinterpret_cast<unsigned char*>(ptr) - offsetof(Slot, storage));
+			Block* block = slot->block;
+			size_t index = (size_t)(slot - block->slots);
+			uint64_t bit = 1ull << (index % 64);
+			uint64_t previous_bits = block->occupied[index / 64].fetch_and(~bit, std::memory_order_relaxed);
+			assert(previous_bits & bit);
+			(void)previous_bits;
+
+			ThreadCache& cache = local_cache();
+			if (cache.loaded == nullptr)
+			{
+				cache.loaded = m_depot->take_empty();
+			}
+			else if (cache.loaded->count == _MAGAZINE_SIZE)
+			{
+				if (cache.previous != nullptr && cache.previous->count == 0)
+				{
+					std::swap(cache.loaded, cache.previous);
+				}
+				else
+				{
+					if (cache.previous != nullptr)
+					{
+						m_depot->push_full(cache.previous);
+					}
+					cache.previous = cache.loaded;
+					cache.loaded = m_depot->take_empty();
+				}
+			}
+
+			cache.loaded->slots[cache.loaded->count++] = slot;
+		}
+
+		template <typename... Args>
+		T* create(Args&&... args)
+		{
+			T* ptr = allocate();
+			// Global placement new, in case T overloads its own
+			return ::new (ptr) T(std::forward<Args>(args)...);
+		}
+
+		void destroy(T* ptr)
+		{
+			if (ptr == nullptr)
+			{
+				return;
+			}
+
+			ptr->~T();
+			deallocate(ptr);
+		}
+
+		Iterator begin() const
+		{
+			const std::vector<Block*>& blocks = m_depot->get_blocks();
+			return Iterator(blocks.data(), blocks.data() + blocks.size());
+		}
+
+		Iterator end() const
+		{
+			const std::vector<Block*>& blocks = m_depot->get_blocks();
+			Block* const* end = blocks.data() + blocks.size();
+			return Iterator(end, end);
+		}
+
+		size_t capacity() const { return get_block_count() * m_depot->get_block_size(); }
+		size_t get_block_count() const { return m_depot->get_block_count(); }
+		size_t get_magazine_count() const { return m_depot->get_magazine_count(); }
+
+	private:
+		std::shared_ptr<Depot> m_depot;
+
+		/**
+		 * This thread's magazines for this pool. A thread usually only
+		 * touches one pool per type, so the last hit is checked first.
+		 */
+		ThreadCache& local_cache()
+		{
+			thread_local std::vector<std::unique_ptr<ThreadCache>> caches;
+			thread_local ThreadCache* last = nullptr;
+
+			Depot* depot = m_depot.get();
+			if (last != nullptr && last->depot.get() == depot)
+			{
+				return *last;
+			}
+
+			for (std::unique_ptr<ThreadCache>& cache : caches)
+			{
+				if (cache->depot.get() == depot)
+				{
+					last = cache.get();
+					return *last;
+				}
+			}
+
+			// First use on this thread; also drop caches of dead pools
+			std::erase_if(caches, [](const std::unique_ptr<ThreadCache>& cache)
+				{
+					return !cache->depot->is_open();
+				});
+
+			caches.push_back(std::make_unique<ThreadCache>());
+			caches.back()->depot = m_depot;
+			last = caches.back().get();
+			return *last;
+		}
+	};
+} // namespace bacon
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace bacon
+{
+	/**
+	 * Open-addressing hash map with linear probing.
+	 * Entries are stored densely and the probe table only holds
+	 * indices into the entry array, so a lookup walks two flat
+	 * arrays and never allocates.
+	 * Removal uses backward-shift deletion (no tombstones) and
+	 * swap-and-pop on the entry array.
+	 */
+	template <typename K, typename V, typename Hash = std::hash<K>, typename Equal = std::equal_to<K>>
+	class FlatHashMap
+	{
+	public:
+		typedef std::pair<K, V> Entry;
+
+		FlatHashMap() = default;
+
+		V* find(const K& key)
+		{
+			size_t slot = find_slot(key);
+			if (slot == _NOT_FOUND)
+			{
+				return nullptr;
+			}
+
+			return &m_entries[m_slots[slot]].second;
+		}
+
+		const V* find(const K& key) const
+		{
+			size_t slot = find_slot(key);
+			if (slot == _NOT_FOUND)
+			{
+				return nullptr;
+			}
+
+			return &m_entries[m_slots[slot]].second;
+		}
+
+		bool contains(const K& key) const
+		{
+			return find_slot(key) != _NOT_FOUND;
+		}
+
+		/**
+		 * Inserts a new entry.
+		 * Returns false (and leaves the map untouched) if the
+		 * key already exists.
+		 */
+		bool insert(const K& key, V value)
+		{
+			if ((m_entries.size() + 1) * 2 > m_slots.size())
+			{
+				rehash(m_slots.empty() ? _MIN_SLOTS : m_slots.size() * 2);
+			}
+
+			size_t mask = m_slots.size() - 1;
+			size_t slot = m_hash(key) & mask;
+			while (m_slots[slot] != _EMPTY)
+			{
+				if (m_equal(m_entries[m_slots[slot]].first, key))
+				{
+					return false;
+				}
+				slot = (slot + 1) & mask;
+			}
+
+			m_slots[slot] = static_cast<uint32_t>(m_entries.size());
+			m_entries.emplace_back(key, std::move(value));
+			return true;
+		}
+
+		bool erase(const K& key)
+		{
+			size_t slot = find_slot(key);
+			if (slot == _NOT_FOUND)
+			{
+				return false;
+			}
+
+			uint32_t index = m_slots[slot];
+			size_t mask = m_slots.size() - 1;
+
+			// Backward-shift deletion: pull later entries of the
+			// probe run into the hole as long as that doesn't move
+			// them before their home slot.
+			size_t hole = slot;
+			size_t next = slot;
+			while (true)
+			{
+				next = (next + 1) & mask;
+				uint32_t entry = m_slots[next];
+				if (entry == _EMPTY)
+				{
+					break;
+				}
+
+				size_t home = m_hash(m_entries[entry].first) & mask;
+				if (((next - home) & mask) >= ((next - hole) & mask))
+				{
+					m_slots[hole] = entry;
+					hole = next;
+				}
+			}
+			m_slots[hole] = _EMPTY;
+
+			// Swap-and-pop the dense entry, re-pointing the slot that
+			// referenced the moved entry.
+			uint32_t last = static_cast<uint32_t>(m_entries.size() - 1);
+			if (index != last)
+			{
+				size_t moved = m_hash(m_entries[last].first) & mask;
+				while (m_slots[moved] != last)
+				{
+					moved = (moved + 1) & mask;
+				}
+				m_slots[moved] = index;
+				m_entries[index] = std::move(m_entries[last]);
+			}
+			m_entries.pop_back();
+
+			return true;
+		}
+
+		void reserve(size_t count)
+		{
+			size_t slot_count = _MIN_SLOTS;
+			while (slot_count < count * 2)
+			{
+				slot_count *= 2;
+			}
+
+			m_entries.reserve(count);
+			if (slot_count > m_slots.size())
+			{
+				rehash(slot_count);
+			}
+		}
+
+		void clear()
+		{
+			m_entries.clear();
+			m_slots.clear();
+		}
+
+		size_t size() const { return m_entries.size(); }
+		bool empty() const { return m_entries.empty(); }
+
+		typename std::vector<Entry>::const_iterator begin() const { return m_entries.begin(); }
+		typename std::vector<Entry>::const_iterator end() const { return m_entries.end(); }
+
+	private:
+		static constexpr uint32_t _EMPTY = UINT32_MAX;
+		static constexpr size_t _NOT_FOUND = SIZE_MAX;
+		static constexpr size_t _MIN_SLOTS = 16;
+
+		std::vector<Entry> m_entries;
+		std::vector<uint32_t> m_slots;
+		Hash m_hash;
+		Equal m_equal;
+
+		size_t find_slot(const K& key) const
+		{
+			if (m_slots.empty())
+			{
+				return _NOT_FOUND;
+			}
+
+			size_t mask = m_slots.size() - 1;
+			size_t slot = m_hash(key) & mask;
+			while (true)
+			{
+				uint32_t entry = m_slots[slot];
+				if (entry == _EMPTY)
+				{
+					return _NOT_FOUND;
+				}
+				if (m_equal(m_entries[entry].first, key))
+				{
+					return slot;
+				}
+				slot = (slot + 1) & mask;
+			}
+		}
+
+		void rehash(size_t slot_count)
+		{
+			m_slots.assign(slot_count, _EMPTY);
+
+			size_t mask = slot_count - 1;
+			for (uint32_t i = 0; i < m_entries.size(); i++)
+			{
+				size_t slot = m_hash(m_entries[i].first) & mask;
+				while (m_slots[slot] != _EMPTY)
+				{
+					slot = (slot + 1) & mask;
+				}
+				m_slots[slot] = i;
+			}
+		}
+	};
+} // namespace bacon
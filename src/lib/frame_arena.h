@@ -0,0 +1,160 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <thread>
+#include <vector>
+
+namespace bacon
+{
+	/**
+	 * Bump allocator for data that only lives until the end of the
+	 * frame, usable anywhere through its std::pmr::memory_resource
+	 * interface (std::pmr::string, std::pmr::vector, ...).
+	 *
+	 * Allocating moves an offset; freeing does nothing, and reset()
+	 * drops everything at once. Requests that don't fit in the
+	 * buffer are served by the upstream resource instead of failing
+	 * and counted as overflow. reset() then regrows the buffer to the
+	 * frame's peak, so one heavy frame doesn't keep spilling.
+	 *
+	 * Only the thread that created the arena may use it.
+	 */
+	class FrameArena : public std::pmr::memory_resource
+	{
+	public:
+		explicit FrameArena(size_t capacity,
+			std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+		{
+			m_upstream = upstream;
+			m_capacity = std::max<size_t>(capacity, _ALIGNMENT);
+			m_buffer = static_cast<unsigned char*>(m_upstream->allocate(m_capacity, _ALIGNMENT));
+			m_owner = std::this_thread::get_id();
+		}
+
+		FrameArena(const FrameArena& arena) = delete;
+		FrameArena& operator=(const FrameArena& arena) = delete;
+
+		~FrameArena()
+		{
+			release_overflow();
+			m_upstream->deallocate(m_buffer, m_capacity, _ALIGNMENT);
+		}
+
+		/**
+		 * Ends the frame. Everything allocated from the arena is
+		 * invalid afterwards. Returns whether the frame overflowed.
+		 */
+		bool reset()
+		{
+			assert(std::this_thread::get_id() == m_owner);
+
+			bool overflowed = !m_overflow.empty();
+			size_t used = get_used();
+
+			m_last_used = used;
+			m_last_overflow = m_overflow_bytes;
+			m_high_water = std::max(m_high_water, used);
+			if (overflowed)
+			{
+				m_overflow_frames++;
+			}
+
+			release_overflow();
+			m_offset = 0;
+			m_allocations = 0;
+
+			if (overflowed)
+			{
+				// Half again the peak, so slow growth doesn't overflow every frame
+				size_t capacity = used + used / 2;
+				capacity = (capacity + _ALIGNMENT - 1) & ~(_ALIGNMENT - 1);
+
+				m_upstream->deallocate(m_buffer, m_capacity, _ALIGNMENT);
+				m_capacity = capacity;
+				m_buffer = static_cast<unsigned char*>(m_upstream->allocate(m_capacity, _ALIGNMENT));
+			}
+
+			return overflowed;
+		}
+
+		// Bytes handed out this frame so far, overflow included
+		size_t get_used() const { return m_offset + m_overflow_bytes; }
+		size_t get_capacity() const { return m_capacity; }
+		size_t get_allocation_count() const { return m_allocations; }
+		// Totals of the last frame that was reset
+		size_t get_last_used() const { return m_last_used; }
+		size_t get_last_overflow() const { return m_last_overflow; }
+		// Peak of any frame so far
+		size_t get_high_water() const { return m_high_water; }
+		uint64_t get_overflow_frames() const { return m_overflow_frames; }
+
+	protected:
+		void* do_allocate(size_t bytes, size_t alignment) override
+		{
+			assert(std::this_thread::get_id() == m_owner);
+
+			m_allocations++;
+
+			uintptr_t base = reinterpret_cast<uintptr_t>(m_buffer);
+			uintptr_t start = (base + m_offset + alignment - 1) & ~(uintptr_t)(alignment - 1);
+			size_t end = (size_t)(start - base) + bytes;
+			if (end <= m_capacity)
+			{
+				m_offset = end;
+				return reinterpret_cast<void*>(start);
+			}
+
+			void* ptr = m_upstream->allocate(bytes, alignment);
+			m_overflow.push_back({ptr, bytes, alignment});
+			m_overflow_bytes += bytes;
+			return ptr;
+		}
+
+		// Memory is reclaimed by reset(), overflow included
+		void do_deallocate(void* ptr, size_t bytes, size_t alignment) override {}
+
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+		{
+			return this == &other;
+		}
+
+	private:
+		static constexpr size_t _ALIGNMENT = alignof(std::max_align_t);
+
+		typedef struct
+		{
+			void* ptr;
+			size_t bytes;
+			size_t alignment;
+		} Overflow;
+
+		std::pmr::memory_resource* m_upstream;
+		unsigned char* m_buffer;
+		size_t m_capacity;
+		size_t m_offset = 0;
+		size_t m_allocations = 0;
+		std::thread::id m_owner;
+
+		std::vector<Overflow> m_overflow;
+		size_t m_overflow_bytes = 0;
+
+		size_t m_last_used = 0;
+		size_t m_last_overflow = 0;
+		size_t m_high_water = 0;
+		uint64_t m_overflow_frames = 0;
+
+		void release_overflow()
+		{
+			for (const Overflow& overflow : m_overflow)
+			{
+				m_upstream->deallocate(overflow.ptr, overflow.bytes, overflow.alignment);
+			}
+			m_overflow.clear();
+			m_overflow_bytes = 0;
+		}
+	};
+} // namespace bacon
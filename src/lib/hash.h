@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+
+namespace bacon
+{
+	static constexpr uint64_t _FNV_OFFSET_BASIS = 14695981039346656037ull;
+	static constexpr uint64_t _FNV_PRIME = 1099511628211ull;
+
+	/**
+	 * 64-bit FNV-1a. Not cryptographic; used for cache keys and
+	 * change detection. Pass a previous result as `hash` to
+	 * continue hashing across buffers.
+	 */
+	inline uint64_t fnv1a_64(const void* data, size_t size, uint64_t hash = _FNV_OFFSET_BASIS)
+	{
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= bytes[i];
+			hash *= _FNV_PRIME;
+		}
+		return hash;
+	}
+
+	inline uint64_t fnv1a_64(std::string_view str, uint64_t hash = _FNV_OFFSET_BASIS)
+	{
+		return fnv1a_64(str.data(), str.size(), hash);
+	}
+
+	/**
+	 * Transparent string hash. With std::equal_to<>, maps keyed by
+	 * any string type can be searched with a string_view, without
+	 * building a key first.
+	 */
+	struct StringHash
+	{
+		using is_transparent = void;
+
+		size_t operator()(std::string_view str) const noexcept
+		{
+			return std::hash<std::string_view>()(str);
+		}
+	};
+} // namespace bacon
@@ -1,131 +1,264 @@
 #pragma once
 
+#include <algorithm>
+#include <bit>
+#include <cassert>
 #include <cstddef>
-#include <cstdlib>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <utility>
 #include <vector>
-#include <cassert>
-#include <stdexcept>
 
 namespace bacon
 {
+	/**
+	 * Object pool made of blocks of `block_size` slots.
+	 *
+	 * Freed slots form an intrusive free list (the link lives in the
+	 * slot itself), so neither allocate nor deallocate touches the
+	 * heap unless a new block is needed. Each block keeps an
+	 * occupancy bitmap, which lets begin()/end() walk every live
+	 * object block by block in address order.
+	 *
+	 * allocate()/deallocate() hand out raw memory, for class-level
+	 * operator new/delete. create()/destroy() also run the
+	 * constructor and destructor. Objects still live when the pool
+	 * is destroyed are released without their destructors.
+	 *
+	 * Not thread-safe.
+	 */
 	template <typename T>
 	class PoolAllocator
 	{
-	public:
+	private:
+		struct Block;
+
+		union Slot
+		{
+			struct
+			{
+				Slot* next;
+				Block* block;
+			} link;
+			alignas(T) unsigned char storage[sizeof(T)];
+		};
+
 		typedef struct Block
 		{
-			T* data;
-			size_t size;
-			size_t capacity;
-			Block* prev;
-			Block* next;
+			Slot* slots;
+			// Slots handed out at least once; the rest are untouched
+			size_t used;
+			size_t live;
+			std::vector<uint64_t> occupied;
+		} Block;
 
-			~Block()
+	public:
+		/**
+		 * Visits live objects in address order. Freeing the current
+		 * object is fine; objects allocated during the walk may or
+		 * may not be visited.
+		 */
+		class Iterator
+		{
+		public:
+			Iterator(Block* const* block, Block* const* end) : m_block(block), m_end(end)
 			{
-				free(data);
+				seek();
 			}
 
-			T* get(size_t index)
+			T* operator*() const
 			{
-				if (index > size || index > capacity || index < 0)
-				{
-					throw std::runtime_error("Index " + std::to_string(index) + " is out of range");
-				}
+				return reinterpret_cast<T*>((*m_block)->slots[m_index].storage);
+			}
 
-				return (data + index);
+			Iterator& operator++()
+			{
+				m_index++;
+				seek();
+				return *this;
 			}
 
-			T* new_item()
+			bool operator==(const Iterator& other) const
 			{
-				return (data + size++);
+				return m_block == other.m_block && m_index == other.m_index;
 			}
-		} Block;
 
-		PoolAllocator(size_t block_size)
-		{
-			m_block_size = block_size;
+			bool operator!=(const Iterator& other) const
+			{
+				return !(*this == other);
+			}
 
-			m_start = new_block();
+		private:
+			Block* const* m_block;
+			Block* const* m_end;
+			size_t m_index = 0;
 
-			m_end = new Block();
-			m_end->data = nullptr;
-			m_end->size = 0;
-			m_end->capacity = 0;
-			m_end->next = nullptr;
+			// Moves to the first live slot at or after the current one
+			void seek()
+			{
+				while (m_block != m_end)
+				{
+					const Block& block = **m_block;
+					size_t word = m_index / 64;
+					if (word < block.occupied.size())
+					{
+						uint64_t bits = block.occupied[word] & (~0ull << (m_index % 64));
+						while (bits == 0 && ++word < block.occupied.size())
+						{
+							bits = block.occupied[word];
+						}
 
-			m_start->next = m_end;
-			m_end->prev = m_start;
+						if (bits != 0)
+						{
+							m_index = word * 64 + (size_t)std::countr_zero(bits);
+							return;
+						}
+					}
 
-			m_current = m_start;
+					m_block++;
+					m_index = 0;
+				}
+			}
+		};
 
-			m_free_list.reserve(block_size);
+		explicit PoolAllocator(size_t block_size)
+		{
+			m_block_size = std::max<size_t>(block_size, 1);
 		}
 
+		PoolAllocator(const PoolAllocator& pool) = delete;
+		PoolAllocator& operator=(const PoolAllocator& pool) = delete;
+
 		~PoolAllocator()
 		{
-			if (m_start == nullptr)
+			for (Block* block : m_blocks)
 			{
-				return;
+				::operator delete(block->slots, std::align_val_t(alignof(Slot)));
+				delete block;
 			}
+		}
 
-			Block* curr = m_start;
-			while (curr != m_end)
+		T* allocate()
+		{
+			Slot* slot;
+			Block* block;
+			size_t index;
+			if (m_free != nullptr)
+			{
+				slot = m_free;
+				block = slot->link.block;
+				m_free = slot->link.next;
+				index = (size_t)(slot - block->slots);
+			}
+			else
 			{
-				// Free block
-				Block* next = curr->next;
-				delete curr;
+				if (m_current == nullptr || m_current->used == m_block_size)
+				{
+					m_current = new_block();
+				}
 
-				// Goto next block
-				curr = next;
+				block = m_current;
+				index = block->used++;
+				slot = block->slots + index;
 			}
+
+			block->occupied[index / 64] |= 1ull << (index % 64);
+			block->live++;
+			m_live++;
+
+			return reinterpret_cast<T*>(slot->storage);
 		}
 
-		T* allocate()
+		void deallocate(T* ptr)
 		{
-			if (!m_free_list.empty())
+			if (ptr == nullptr)
 			{
-				T* ptr = m_free_list.back();
-				m_free_list.pop_back();
-				return ptr;
+				return;
 			}
 
-			if (m_current->size >= m_current->capacity)
+			Slot* slot = reinterpret_cast<Slot*>(ptr);
+			Block* block = find_block(slot);
+			size_t index = (size_t)(slot - block->slots);
+			assert((block->occupied[index / 64] >> (index % 64)) & 1ull);
+
+			block->occupied[index / 64] &= ~(1ull << (index % 64));
+			block->live--;
+			m_live--;
+
+			slot->link.next = m_free;
+			slot->link.block = block;
+			m_free = slot;
+		}
+
+		template <typename... Args>
+		T* create(Args&&... args)
+		{
+			T* ptr = allocate();
+			// Global placement new, in case T overloads its own
+			return ::new (ptr) T(std::forward<Args>(args)...);
+		}
+
+		void destroy(T* ptr)
+		{
+			if (ptr == nullptr)
 			{
-				Block* block = new_block();
-				block->prev = m_current;
-				m_current->next = block;
-				m_current = block;
-				m_end->prev = m_current;
+				return;
 			}
 
-			return m_current->new_item();
+			ptr->~T();
+			deallocate(ptr);
 		}
 
-		void deallocate(T* ptr)
+		Iterator begin() const { return Iterator(m_blocks.data(), m_blocks.data() + m_blocks.size()); }
+		Iterator end() const
 		{
-			m_free_list.push_back((T*)ptr);
+			Block* const* end = m_blocks.data() + m_blocks.size();
+			return Iterator(end, end);
 		}
 
-		Block* start() { return m_start; };
-		Block* end() { return m_end; };
+		size_t size() const { return m_live; }
+		size_t capacity() const { return m_blocks.size() * m_block_size; }
+		size_t get_block_count() const { return m_blocks.size(); }
 
 	private:
 		size_t m_block_size;
-		Block* m_start;
-		Block* m_end;
-		Block* m_current;
-		std::vector<T*> m_free_list;
+		size_t m_live = 0;
+		// Sorted by address, so a slot's block can be found by search
+		std::vector<Block*> m_blocks;
+		// Block that fresh slots are taken from
+		Block* m_current = nullptr;
+		Slot* m_free = nullptr;
 
 		Block* new_block()
 		{
 			Block* block = new Block;
-			block->data = (T*)malloc(sizeof(T) * m_block_size);
-			block->size = 0;
-			block->capacity = m_block_size;
-			block->prev = nullptr;
-			block->next = nullptr;
+			block->slots = static_cast<Slot*>(
+				::operator new(sizeof(Slot) * m_block_size, std::align_val_t(alignof(Slot))));
+			block->used = 0;
+			block->live = 0;
+			block->occupied.assign((m_block_size + 63) / 64, 0);
+
+			auto it = std::upper_bound(m_blocks.begin(), m_blocks.end(), block,
+				[](const Block* a, const Block* b)
+				{
+					return std::less<const Slot*>()(a->slots, b->slots);
+				});
+			m_blocks.insert(it, block);
 
 			return block;
 		}
+
+		Block* find_block(const Slot* slot) const
+		{
+			auto it = std::upper_bound(m_blocks.begin(), m_blocks.end(), slot,
+				[](const Slot* slot, const Block* block)
+				{
+					return std::less<const Slot*>()(slot, block->slots);
+				});
+			assert(it != m_blocks.begin());
+
+			return *(it - 1);
+		}
 	};
 } // namespace bacon
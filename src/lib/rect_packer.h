@@ -0,0 +1,166 @@
+#pragma once
+
+#include <climits>
+#include <cstddef>
+#include <vector>
+
+namespace bacon
+{
+	/**
+	 * Skyline bottom-left rectangle packer.
+	 * Keeps the top edge of the packed area as a list of horizontal
+	 * segments and places each rectangle where it ends up lowest,
+	 * breaking ties by the narrowest fit.
+	 */
+	class RectPacker
+	{
+	public:
+		RectPacker(int width, int height)
+		{
+			reset(width, height);
+		}
+
+		void reset(int width, int height)
+		{
+			m_width = width;
+			m_height = height;
+			m_skyline.clear();
+			m_skyline.push_back({0, 0, width});
+		}
+
+		int get_width() const { return m_width; }
+		int get_height() const { return m_height; }
+
+		/**
+		 * Finds a spot for a width x height rectangle.
+		 * Returns false if it doesn't fit in the remaining space.
+		 */
+		bool pack(int width, int height, int* out_x, int* out_y)
+		{
+			if (width <= 0 || height <= 0 || width > m_width || height > m_height)
+			{
+				return false;
+			}
+
+			size_t best_index = SIZE_MAX;
+			int best_y = INT_MAX;
+			int best_width = INT_MAX;
+
+			for (size_t i = 0; i < m_skyline.size(); i++)
+			{
+				int y;
+				if (!fits(i, width, height, &y))
+				{
+					continue;
+				}
+
+				if (y < best_y || (y == best_y && m_skyline[i].width < best_width))
+				{
+					best_index = i;
+					best_y = y;
+					best_width = m_skyline[i].width;
+				}
+			}
+
+			if (best_index == SIZE_MAX)
+			{
+				return false;
+			}
+
+			*out_x = m_skyline[best_index].x;
+			*out_y = best_y;
+			add_segment(best_index, *out_x, best_y + height, width);
+			return true;
+		}
+
+	private:
+		typedef struct
+		{
+			int x;
+			int y;
+			int width;
+		} Segment;
+
+		int m_width;
+		int m_height;
+		std::vector<Segment> m_skyline;
+
+		/**
+		 * Checks if a rectangle starting at segment `index` fits,
+		 * writing the y it would rest at.
+		 */
+		bool fits(size_t index, int width, int height, int* out_y) const
+		{
+			int x = m_skyline[index].x;
+			if (x + width > m_width)
+			{
+				return false;
+			}
+
+			int y = 0;
+			int remaining = width;
+			while (remaining > 0)
+			{
+				if (index >= m_skyline.size())
+				{
+					return false;
+				}
+
+				if (m_skyline[index].y > y)
+				{
+					y = m_skyline[index].y;
+				}
+				if (y + height > m_height)
+				{
+					return false;
+				}
+
+				remaining -= m_skyline[index].width;
+				index++;
+			}
+
+			*out_y = y;
+			return true;
+		}
+
+		void add_segment(size_t index, int x, int y, int width)
+		{
+			m_skyline.insert(m_skyline.begin() + index, {x, y, width});
+
+			// Trim or remove the segments now covered by the new one
+			size_t i = index + 1;
+			while (i < m_skyline.size())
+			{
+				Segment& segment = m_skyline[i];
+				int covered = (x + width) - segment.x;
+				if (covered <= 0)
+				{
+					break;
+				}
+
+				if (covered < segment.width)
+				{
+					segment.x += covered;
+					segment.width -= covered;
+					break;
+				}
+
+				m_skyline.erase(m_skyline.begin() + i);
+			}
+
+			// Merge neighbours at the same height
+			for (size_t j = 0; j + 1 < m_skyline.size();)
+			{
+				if (m_skyline[j].y == m_skyline[j + 1].y)
+				{
+					m_skyline[j].width += m_skyline[j + 1].width;
+					m_skyline.erase(m_skyline.begin() + j + 1);
+				}
+				else
+				{
+					j++;
+				}
+			}
+		}
+	};
+} // namespace bacon
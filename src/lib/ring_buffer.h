@@ -2,7 +2,9 @@
 
 #include <cstddef>
 #include <cstdlib>
+#include <cstring>
 #include <stdexcept>
+#include <string>
 
 namespace bacon
 {
@@ -77,6 +79,26 @@ namespace bacon
 			return m_buffer[index];
 		}
 
+		/**
+		 * Element by logical position, 0 being the oldest.
+		 */
+		T& at(size_t index) const
+		{
+			if (index >= m_count)
+			{
+				throw std::runtime_error("Index " + std::to_string(index) + " is out of range");
+			}
+
+			return m_buffer[(m_tail + index) % m_capacity];
+		}
+
+		void clear()
+		{
+			m_head = 0;
+			m_tail = 0;
+			m_count = 0;
+		}
+
 		size_t size() const { return m_count; }
 		size_t capacity() const { return m_capacity; }
 
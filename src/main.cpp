@@ -17,6 +17,9 @@
 #include "editor/ui/editor_ui.h"
 #include "core/2D/camera_object.h"
 #include "core/game_state.h"
+#include "core/job_system.h"
+#include "core/profiler.h"
+#include "file/project_loader.h"
 #include "lib/pool_allocator.h"
 
 int main(int argc, char** argv)
@@ -24,6 +27,7 @@ int main(int argc, char** argv)
 	using namespace bacon;
 
 	debug_log("Starting BaconEngine...");
+	profiler::set_thread_name("Main");
 
 	globals::engine_version = "v0.1";
 
@@ -34,6 +38,11 @@ int main(int argc, char** argv)
 	NFD_Init();
 	debug_log("NativeFileDialog initialized.");
 
+	// Worker threads (0 = one per hardware thread)
+	globals::job_system = new JobSystem(0);
+	globals::project_loader = new ProjectLoader();
+	globals::frame_arena = new FrameArena(globals::frame_arena_size);
+
 	// Setup
 	Editor editor;
 	editor.set_framerate_limit(165);
@@ -44,13 +53,22 @@ int main(int argc, char** argv)
 	globals::project_directory = "/home/jackson/BaconEngine/projects/test2";
 	globals::project_file =
 		"/home/jackson/BaconEngine/projects/test2/game.json";
-	file::load_project(false);
 	GameState::game_type = GameState::GameType::GAME_2D; // TODO
+	GameState::state_2d = new GameState2D();
+	globals::project_loader->begin(globals::project_file);
 
 	debug_log("Engine startup successful.");
 
 	while (globals::program_running)
 	{
+		PROFILE_FRAME();
+
+		globals::project_loader->update();
+		if (GameState::game_type == GameState::GameType::GAME_2D)
+		{
+			GameState::state_2d->update_assets();
+		}
+
 		if (editor.is_playing)
 		{
 			if (GameState::game_type == GameState::GameType::GAME_2D)
@@ -86,11 +104,25 @@ int main(int argc, char** argv)
 
 		editor.draw_ui();
 		EndDrawing();
+
+		// Nothing allocated from the frame arena outlives the frame
+		FrameArena* arena = globals::frame_arena;
+		if (arena->reset())
+		{
+			debug_warn("Frame arena overflowed by %zu bytes, grown to %zu bytes",
+				arena->get_last_overflow(), arena->get_capacity());
+		}
 	}
 
 	debug_log("Performing cleanup...");
 	event::event_cleanup();
+	delete globals::project_loader;
+	globals::project_loader = nullptr;
 	GameState::cleanup();
+	delete globals::job_system;
+	globals::job_system = nullptr;
+	delete globals::frame_arena;
+	globals::frame_arena = nullptr;
 	if (ui::inspect_object_copy)
 	{
 		ui::inspect_object_copy->delete_children();
@@ -1,9 +1,16 @@
 #include "rendering/2D/renderer_2d.h"
 
+#include <algorithm>
+#include <cmath>
 #include <vector>
 
 #include "raylib.h"
+#include "rlgl.h"
 
+#include "core/2D/entity_2d.h"
+
+#include "core/globals.h"
+#include "core/profiler.h"
 #include "editor/ui/editor_ui.h"
 #include "core/util.h"
 
@@ -16,7 +23,7 @@ namespace bacon
 		for (size_t i = 0; i < _MAX_LAYERS; i++)
 		{
 			this->m_layers[i] =
-				(RenderLayer){i, true, std::vector<Object2D*>()};
+				(RenderLayer){i, true, std::vector<Object2D*>(), 0};
 		}
 	}
 
@@ -32,62 +39,266 @@ namespace bacon
 		this->frame = LoadRenderTexture(m_frame_width, m_frame_height);
 	}
 
+	/**
+	 * Appends the object to a layer. An object that is already in
+	 * another layer is moved; one already in this layer stays put.
+	 */
 	void Renderer2D::add_to_layer(Object2D* object, size_t layer)
 	{
-		if (layer < 0 || layer >= _MAX_LAYERS)
+		if (layer >= _MAX_LAYERS)
 		{
-			debug_error("Layer %ul is out of bounds", layer);
+			debug_error("Layer %zu is out of bounds", layer);
 		}
 
-		size_t layer_val = std::clamp(layer, (size_t)0, _MAX_LAYERS);
-		this->m_layers[layer_val].objects.push_back(object);
-	}
+		size_t layer_val = std::min(layer, _MAX_LAYERS - 1);
 
-	void Renderer2D::remove_from_layer(Object2D* object)
-	{
-		size_t current_layer = object->get_layer();
+		TransformHandle handle = object->get_transform_handle();
+		if (handle >= m_layer_slots.size())
+		{
+			m_layer_slots.resize((size_t)handle + 1, {_NO_SLOT, _NO_SLOT});
+		}
 
-		bool found = false;
-		RenderLayer* layer = &this->m_layers[current_layer];
-		for (auto it = layer->objects.begin(); it != layer->objects.end(); it++)
+		LayerSlot& slot = m_layer_slots[handle];
+		if (slot.index != _NO_SLOT && m_layers[slot.layer].objects[slot.index] == object)
 		{
-			Object2D* obj = *it;
-			if (obj->get_uuid() == object->get_uuid())
+			if (slot.layer == layer_val)
 			{
-				layer->objects.erase(it);
-				found = true;
-				break;
+				return;
 			}
+			remove_from_layer(object);
 		}
 
-		if (!found)
+		RenderLayer& target = this->m_layers[layer_val];
+		slot = {(uint32_t)layer_val, (uint32_t)target.objects.size()};
+		target.objects.push_back(object);
+	}
+
+	/**
+	 * Removes the object in O(1) by leaving a hole, so the draw
+	 * order of the rest is kept. Holes are compacted by the next
+	 * draw, or sooner once they make up half the layer.
+	 */
+	void Renderer2D::remove_from_layer(Object2D* object)
+	{
+		TransformHandle handle = object->get_transform_handle();
+		if (handle >= m_layer_slots.size() || m_layer_slots[handle].index == _NO_SLOT ||
+			m_layers[m_layer_slots[handle].layer].objects[m_layer_slots[handle].index] != object)
 		{
 			debug_warn("Object not found at expected RenderLayer (This is "
 					   "probably fine.)");
+			return;
+		}
+
+		LayerSlot& slot = m_layer_slots[handle];
+		RenderLayer& layer = m_layers[slot.layer];
+		layer.objects[slot.index] = nullptr;
+		layer.removed++;
+		slot = {_NO_SLOT, _NO_SLOT};
+
+		if (layer.removed * 2 > layer.objects.size())
+		{
+			compact_layer(layer);
+		}
+	}
+
+	/**
+	 * Drops the holes left by remove_from_layer() in one pass.
+	 */
+	void Renderer2D::compact_layer(RenderLayer& layer)
+	{
+		size_t count = 0;
+		for (Object2D* object : layer.objects)
+		{
+			if (object == nullptr)
+			{
+				continue;
+			}
+
+			m_layer_slots[object->get_transform_handle()].index = (uint32_t)count;
+			layer.objects[count++] = object;
 		}
+
+		layer.objects.resize(count);
+		layer.removed = 0;
 	}
 
-	void Renderer2D::draw(Camera2D* camera) const
+	void Renderer2D::draw(Camera2D* camera)
 	{
+		PROFILE_SCOPE("Renderer2D::draw");
+
+		for (RenderLayer& layer : m_layers)
+		{
+			if (layer.removed > 0)
+			{
+				compact_layer(layer);
+			}
+		}
+
+		m_stats = {0, 0, 0};
+		Rectangle view = get_view_bounds(*camera);
+
+		// Cull in one linear pass over the packed bounds array
+		if (cull_objects)
+		{
+			const TransformStore2D& transforms = Object2D::_transforms;
+			transforms.assert_owner();
+
+			const size_t count = transforms.capacity();
+			m_in_view.resize(count);
+			for (size_t i = 0; i < count; i++)
+			{
+				m_in_view[i] = CheckCollisionRecs(transforms.bounds[i], view);
+			}
+		}
+
 		BeginTextureMode(this->frame);
 		ClearBackground(DARKGRAY);
 
 		BeginMode2D(*camera);
 		for (const RenderLayer& layer : this->m_layers)
 		{
-			for (Object2D* object : layer.objects)
+			draw_layer(layer);
+		}
+		EndMode2D();
+
+		EndTextureMode();
+	}
+
+	/**
+	 * Draws the visible objects of a layer.
+	 * Consecutive textured entities that share a texture are
+	 * submitted as one rlgl batch. Layers listed in
+	 * globals::texture_sorted_layers also reorder sprites by
+	 * texture to make longer runs, but never across an object that
+	 * draws itself (text, untextured entities), so those keep
+	 * their place relative to the sprites around them.
+	 */
+	void Renderer2D::draw_layer(const RenderLayer& layer) const
+	{
+		PROFILE_SCOPE("Renderer2D::draw_layer");
+
+		Object2D* outline_object = nullptr;
+
+		m_draw_list.clear();
+		for (Object2D* object : layer.objects)
+		{
+			if (ui::view_properties_object == object)
+			{
+				outline_object = object;
+			}
+
+			if (cull_objects && !m_in_view[object->get_transform_handle()])
 			{
-				object->draw();
+				m_stats.culled++;
+				continue;
+			}
 
-				if (ui::view_properties_object == object)
+			const Texture2D* texture = nullptr;
+			Entity2D* entity = dynamic_cast_to<Entity2D>(object);
+			if (entity != nullptr)
+			{
+				if (!entity->get_visible())
 				{
-					object->draw_outline();
+					continue;
+				}
+
+				texture = entity->get_texture();
+				if (texture != nullptr && texture->id == 0)
+				{
+					texture = nullptr;
 				}
 			}
+
+			m_draw_list.push_back({object, texture, (uint32_t)m_draw_list.size()});
+			m_stats.drawn++;
 		}
-		EndMode2D();
 
-		EndTextureMode();
+		if ((globals::texture_sorted_layers >> layer.layer_num) & 1u)
+		{
+			// Ties keep layer order through `order`, which stable_sort
+			// would give too, but only by allocating a buffer every call.
+			auto by_texture = [](const DrawItem& a, const DrawItem& b)
+			{
+				if (a.texture->id != b.texture->id)
+				{
+					return a.texture->id < b.texture->id;
+				}
+				return a.order < b.order;
+			};
+
+			// Sort each run of sprites between objects that draw themselves
+			auto run_start = m_draw_list.begin();
+			while (run_start != m_draw_list.end())
+			{
+				auto run_end = std::find_if(run_start, m_draw_list.end(),
+					[](const DrawItem& item) { return item.texture == nullptr; });
+				std::sort(run_start, run_end, by_texture);
+
+				run_start = (run_end != m_draw_list.end()) ? run_end + 1 : run_end;
+			}
+		}
+
+		size_t i = 0;
+		while (i < m_draw_list.size())
+		{
+			const DrawItem& item = m_draw_list[i];
+			if (item.texture == nullptr)
+			{
+				item.object->draw();
+				m_stats.draw_calls++;
+				i++;
+				continue;
+			}
+
+			unsigned int texture_id = item.texture->id;
+
+			rlSetTexture(texture_id);
+			rlBegin(RL_QUADS);
+			while (i < m_draw_list.size() &&
+				m_draw_list[i].texture != nullptr &&
+				m_draw_list[i].texture->id == texture_id)
+			{
+				assured_cast<Entity2D>(m_draw_list[i].object)->draw_quad();
+				i++;
+			}
+			rlEnd();
+			rlSetTexture(0);
+
+			m_stats.draw_calls++;
+		}
+
+		if (outline_object != nullptr)
+		{
+			outline_object->draw_outline();
+		}
+	}
+
+	/**
+	 * World-space axis-aligned rectangle visible through
+	 * the camera in this renderer's frame.
+	 */
+	Rectangle Renderer2D::get_view_bounds(const Camera2D& camera) const
+	{
+		Vector2 corners[4] = {
+			{0.f, 0.f},
+			{(float)m_frame_width, 0.f},
+			{(float)m_frame_width, (float)m_frame_height},
+			{0.f, (float)m_frame_height},
+		};
+
+		Vector2 min = {INFINITY, INFINITY};
+		Vector2 max = {-INFINITY, -INFINITY};
+		for (const Vector2& corner : corners)
+		{
+			Vector2 world = GetScreenToWorld2D(corner, camera);
+
+			min.x = fminf(min.x, world.x);
+			min.y = fminf(min.y, world.y);
+			max.x = fmaxf(max.x, world.x);
+			max.y = fmaxf(max.y, world.y);
+		}
+
+		return {min.x, min.y, max.x - min.x, max.y - min.y};
 	}
 
 	void Renderer2D::reset()
@@ -95,7 +306,9 @@ namespace bacon
 		for (RenderLayer& layer : this->m_layers)
 		{
 			layer.objects.clear();
+			layer.removed = 0;
 		}
+		m_layer_slots.clear();
 	}
 
 	void Renderer2D::debug_print_layers()
@@ -105,6 +318,9 @@ namespace bacon
 			std::cout << "Layer " << layer.layer_num << ":" << std::endl;
 			for (const Object2D* object : layer.objects)
 			{
+				if (object == nullptr)
+					continue;
+
 				std::cout << "\t" << object->get_name() << std::endl;
 			}
 		}
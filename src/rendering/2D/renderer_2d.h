@@ -13,15 +13,44 @@ namespace bacon
     {
         size_t layer_num;
         bool visible;
+        // In draw order. Removed objects leave a nullptr until the
+        // layer is compacted.
         std::vector<Object2D*> objects;
+        size_t removed;
     } RenderLayer;
 
+    // Where an object sits in m_layers, by transform handle
+    typedef struct
+    {
+        uint32_t layer;
+        uint32_t index;
+    } LayerSlot;
+
+    typedef struct
+    {
+        uint32_t drawn;
+        uint32_t culled;
+        uint32_t draw_calls;
+    } RenderStats;
+
+    typedef struct
+    {
+        Object2D* object;
+        // Texture for batched sprites, nullptr for objects
+        // that draw themselves.
+        const Texture2D* texture;
+        // Position in the layer, which breaks ties between equal textures
+        uint32_t order;
+    } DrawItem;
+
     class Renderer2D
     {
     public:
         static constexpr size_t _MAX_LAYERS = 10;
+        static constexpr uint32_t _NO_SLOT = UINT32_MAX;
 
         RenderTexture2D frame;
+        bool cull_objects = true;
 
         Renderer2D(uint32_t width, uint32_t height);
         ~Renderer2D() = default;
@@ -29,17 +58,30 @@ namespace bacon
         void create_frame(uint32_t width, uint32_t height);
         void add_to_layer(Object2D* object, size_t layer);
         void remove_from_layer(Object2D* object);
-        void draw(Camera2D* camera) const;
+        void draw(Camera2D* camera);
 
         void reset();
         void debug_print_layers();
 
         uint32_t get_width() const;
         uint32_t get_height() const;
+        const RenderStats& get_stats() const { return m_stats; }
+        Rectangle get_view_bounds(const Camera2D& camera) const;
 
     private:
         uint32_t m_frame_width = 0;
         uint32_t m_frame_height = 0;
         std::array<RenderLayer, _MAX_LAYERS> m_layers;
+        std::vector<LayerSlot> m_layer_slots;
+
+        // Counters for the last frame drawn
+        mutable RenderStats m_stats = {0, 0, 0};
+        // Scratch list reused across frames
+        mutable std::vector<DrawItem> m_draw_list;
+        // Per transform handle: whether its bounds overlap the view
+        mutable std::vector<uint8_t> m_in_view;
+
+        void draw_layer(const RenderLayer& layer) const;
+        void compact_layer(RenderLayer& layer);
     };
 } // namespace bacon